@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cctype>
+#include <queue>
+
+#include "ahoCorasick.hpp"
+
+int AhoCorasick::symbol(unsigned char c) {
+    if (c >= 'a' && c <= 'z') return 1 + (c - 'a');
+    if (c >= 'A' && c <= 'Z') return 1 + (c - 'A');
+    if (c == '-') return 27;
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') return 28;
+    return 0;
+}
+
+// ASCII case-insensitive comparison, with all whitespace equal as it is in the automaton
+static bool same_byte(unsigned char a, unsigned char b) {
+    auto is_space = [](unsigned char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; };
+    return std::tolower(a) == std::tolower(b) || (is_space(a) && is_space(b));
+}
+
+static bool same_text(const std::string& a, const char* b) {
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!same_byte(static_cast<unsigned char>(a[i]), static_cast<unsigned char>(b[i]))) return false;
+    }
+    return true;
+}
+
+static bool same_text(const std::string& a, const std::string& b) { return a.size() == b.size() && same_text(a, b.data()); }
+
+void AhoCorasick::build(const std::vector<std::pair<std::string, uint32_t>>& patterns) {
+    next.assign(kAlphabet, kNone);
+    pattern_id.assign(1, kNone);
+    pattern_len.assign(1, 0);
+    output_link.assign(1, 0);
+    spellings.clear();
+
+    // Step 1: Insert every pattern into a trie
+    for (const auto& [text, id] : patterns) {
+        if (text.empty()) continue;
+
+        uint32_t node = 0;
+        bool has_other = false;
+        for (unsigned char c : text) {
+            has_other |= symbol(c) == 0;
+            size_t slot = static_cast<size_t>(node) * kAlphabet + symbol(c);
+            if (next[slot] == kNone) {
+                uint32_t child = static_cast<uint32_t>(pattern_id.size());
+                next[slot] = child;
+                next.resize(next.size() + kAlphabet, kNone);
+                pattern_id.push_back(kNone);
+                pattern_len.push_back(0);
+                output_link.push_back(0);
+            }
+            node = next[static_cast<size_t>(node) * kAlphabet + symbol(c)];
+        }
+
+        // The first registration of a phrase wins
+        if (pattern_id[node] == kNone) {
+            pattern_id[node] = id;
+            pattern_len[node] = static_cast<uint32_t>(text.size());
+        }
+        // Phrases that only differ in "other" bytes share the node; each keeps its own spelling
+        if (has_other) {
+            auto& list = spellings[node];
+            bool seen = std::any_of(list.begin(), list.end(), [&](const auto& s) { return same_text(s.first, text); });
+            if (!seen) list.emplace_back(text, id);
+        }
+    }
+
+    // Step 2: Breadth-first pass computing failure links and filling in the missing transitions
+    std::vector<uint32_t> fail(pattern_id.size(), 0);
+    std::queue<uint32_t> queue;
+
+    for (int c = 0; c < kAlphabet; ++c) {
+        uint32_t child = next[c];
+        if (child == kNone) {
+            next[c] = 0;
+        } else {
+            fail[child] = 0;
+            queue.push(child);
+        }
+    }
+
+    while (!queue.empty()) {
+        uint32_t node = queue.front();
+        queue.pop();
+
+        for (int c = 0; c < kAlphabet; ++c) {
+            size_t slot = static_cast<size_t>(node) * kAlphabet + c;
+            uint32_t fallback = next[static_cast<size_t>(fail[node]) * kAlphabet + c];
+
+            if (next[slot] == kNone) {
+                next[slot] = fallback;
+                continue;
+            }
+
+            uint32_t child = next[slot];
+            fail[child] = fallback;
+            output_link[child] = pattern_id[fallback] != kNone ? fallback : output_link[fallback];
+            queue.push(child);
+        }
+    }
+}
+
+std::vector<EntityMatch> AhoCorasick::find_all(const std::string& text) const {
+    std::vector<EntityMatch> matches;
+    if (empty()) return matches;
+
+    auto is_word_char = [&](size_t i) {
+        return i < text.size() && std::isalpha(static_cast<unsigned char>(text[i]));
+    };
+
+    uint32_t state = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        state = next[static_cast<size_t>(state) * kAlphabet + symbol(static_cast<unsigned char>(text[i]))];
+
+        uint32_t node = pattern_id[state] != kNone ? state : output_link[state];
+        while (node != 0) {
+            size_t end = i + 1;
+            size_t begin = end - pattern_len[node];
+
+            // Only whole words count, so "egg" does not match inside "eggplant"
+            if ((begin == 0 || !is_word_char(begin - 1)) && !is_word_char(end)) {
+                auto spelled = spellings.find(node);
+                if (spelled == spellings.end()) {
+                    matches.push_back({pattern_id[node], static_cast<uint32_t>(begin), static_cast<uint32_t>(end)});
+                } else {
+                    for (const auto& [pattern, id] : spelled->second) {
+                        if (same_text(pattern, text.data() + begin))
+                            matches.push_back({id, static_cast<uint32_t>(begin), static_cast<uint32_t>(end)});
+                    }
+                }
+            }
+            node = output_link[node];
+        }
+    }
+
+    return matches;
+}
+
+std::vector<EntityMatch> keep_longest_matches(const std::vector<EntityMatch>& matches) {
+    std::vector<EntityMatch> sorted = matches;
+    std::sort(sorted.begin(), sorted.end(), [](const EntityMatch& a, const EntityMatch& b) {
+        if (a.begin != b.begin) return a.begin < b.begin;
+        return a.end > b.end;
+    });
+
+    std::vector<EntityMatch> result;
+    uint32_t covered_until = 0;
+    for (const EntityMatch& m : sorted) {
+        if (!result.empty() && m.end <= covered_until) continue;
+        result.push_back(m);
+        covered_until = std::max(covered_until, m.end);
+    }
+    return result;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct EntityMatch {
+    uint32_t id;     // id the matched pattern was registered with
+    uint32_t begin;  // byte offsets into the searched text
+    uint32_t end;
+};
+
+// Multi-pattern matcher that finds every whole-word occurrence of a fixed set of phrases
+// in one linear pass over the text. Matching is ASCII case-insensitive; the automaton is
+// stored as a full transition table over a reduced alphabet (letters, '-', space, other).
+// Digits, punctuation and UTF-8 bytes all share the "other" symbol, so a phrase containing
+// them is compared against its own bytes before a match is reported ("1% milk" vs "2% milk").
+class AhoCorasick {
+public:
+    // Each pattern is a lowercase phrase, usually of letters, hyphens and single spaces
+    void build(const std::vector<std::pair<std::string, uint32_t>>& patterns);
+
+    // All matches in order of their end offset; overlapping matches are all reported
+    std::vector<EntityMatch> find_all(const std::string& text) const;
+
+    bool empty() const { return pattern_id.size() <= 1; }
+    size_t node_count() const { return pattern_id.size(); }
+
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+private:
+    static constexpr int kAlphabet = 29;
+    static int symbol(unsigned char c);
+
+    std::vector<uint32_t> next;        // node * kAlphabet + symbol -> node
+    std::vector<uint32_t> pattern_id;  // id of the pattern ending at a node, or kNone
+    std::vector<uint32_t> pattern_len;
+    std::vector<uint32_t> output_link; // nearest proper suffix node that ends a pattern, or 0
+    // Nodes reached through the "other" symbol: every distinct pattern ending there with its id
+    std::unordered_map<uint32_t, std::vector<std::pair<std::string, uint32_t>>> spellings;
+};
+
+// Drops matches contained in a longer match, e.g. "sugar" inside "brown sugar"
+std::vector<EntityMatch> keep_longest_matches(const std::vector<EntityMatch>& matches);
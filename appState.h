@@ -16,6 +16,8 @@ struct AppState {
 	std::string current_recipe;
 	std::vector<Ingredient> current_ingredients;
 	std::string current_directions = "";
+	int current_recipe_idx = -1; // index into recipes of the recipe shown above
+
 	Page previousPage;
 	Page currentPage = Page::MainMenu;
 	ImFont* font_normal = nullptr;
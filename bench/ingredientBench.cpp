@@ -0,0 +1,815 @@
+// Headless benchmark and regression check for the ingredient parsing pipeline.
+//
+//   ingredient_bench [--generate | --postings | --near-duplicates | --vectors | --substring]
+//                    [recipes.csv] [golden_ingredients.tsv]
+//
+// --generate rewrites the golden corpus from the reference implementation below
+// (the original parser and cleaner). Without it, every implementation is timed and
+// its output compared against the corpus, and the Recipe Time box parser is checked against
+// a table of filters; any divergence makes the run fail.
+// --postings times the posting list kernels on lists that follow the ingredient
+// frequencies of recipes.csv, scaled up to a million recipes.
+// --near-duplicates lists recipe pairs whose canonical ingredient sets are nearly identical,
+// found through the MinHash/LSH index, and checks them against an all-pairs comparison.
+// --vectors times building, saving and loading the TF-IDF vector graph and measures the recall
+// of its approximate k-NN queries against exact ones.
+// --substring checks the packed-key substring kernels against std::string::find over every key
+// and times them, with the name n-gram index alongside.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "data.hpp"
+#include "ingredientDictionary.hpp"
+#include "postingList.hpp"
+#include "recipeSearch.hpp"
+#include "searchIndex.hpp"
+#include "threadPool.hpp"
+
+// Allocation counting for the allocations-per-ingredient column. Every replaceable form is
+// defined, so no new/delete pair mixes this allocator with the library's.
+static std::atomic<uint64_t> allocation_count{0};
+
+static void* counted_alloc(size_t size, size_t alignment = 0) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static void* counted_alloc_or_throw(size_t size, size_t alignment = 0) {
+    if (void* p = counted_alloc(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size) { return counted_alloc_or_throw(size); }
+void* operator new[](size_t size) { return counted_alloc_or_throw(size); }
+void* operator new(size_t size, std::align_val_t a) { return counted_alloc_or_throw(size, static_cast<size_t>(a)); }
+void* operator new[](size_t size, std::align_val_t a) { return counted_alloc_or_throw(size, static_cast<size_t>(a)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+void* operator new(size_t size, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, static_cast<size_t>(a));
+}
+void* operator new[](size_t size, std::align_val_t a, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, static_cast<size_t>(a));
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+// Reference implementations, kept exactly as the parser and cleaner were first written
+
+static std::vector<Ingredient> reference_parse_ingredients(const std::string& ingredients_text) {
+    std::vector<Ingredient> result;
+    std::stringstream ss(ingredients_text);
+    std::string token;
+
+    while (std::getline(ss, token, ',')) {
+        Ingredient ing;
+        std::istringstream iss(token);
+        std::string word;
+
+        std::string quantity_part;
+        while (iss >> word) {
+            if (std::regex_match(word, std::regex(R"([\d¼½¾⅓⅔⅛⅜⅝⅞/\.]+)"))) {
+                if (!quantity_part.empty())
+                    quantity_part += " ";
+                quantity_part += word;
+            } else {
+                break;
+            }
+        }
+        ing.quantity = quantity_part;
+
+        std::string unit_candidate = word;
+        std::transform(unit_candidate.begin(), unit_candidate.end(), unit_candidate.begin(), ::tolower);
+        ing.unit = unit_candidate;
+
+        while (iss >> word) {
+            ing.name += word + " ";
+        }
+        ing.name.erase(ing.name.find_last_not_of(" \t\n\r\f\v") + 1);
+
+        result.push_back(ing);
+    }
+
+    return result;
+}
+
+static void reference_clean_ingredients(std::vector<Recipe>& target) {
+    std::unordered_map<std::string, std::string> unit_map = {
+        {"T", "tbsp"}, {"Tbsp", "tbsp"}, {"TBS", "tbsp"}, {"Tablespoon", "tbsp"},
+        {"tablespoons", "tbsp"}, {"tablespoon", "tbsp"}, {"t", "tsp"},
+        {"tsp", "tsp"}, {"Teaspoon", "tsp"}, {"teaspoons", "tsp"}, {"teaspoon", "tsp"},
+        {"C", "cup"}, {"Cup", "cup"}, {"cups", "cup"}, {"c", "cup"},
+        {"oz", "oz"}, {"ounce", "oz"}, {"ounces", "oz"},
+        {"ml", "mL"}, {"l", "L"}, {"g", "g"}, {"kg", "kg"}
+    };
+
+    std::unordered_map<std::string, std::string> ascii_to_unicode = {
+        {"1/4", "¼"}, {"1/2", "½"}, {"3/4", "¾"},
+        {"1/3", "⅓"}, {"2/3", "⅔"},
+        {"1/5", "⅕"}, {"2/5", "⅖"}, {"3/5", "⅗"}, {"4/5", "⅘"},
+        {"1/6", "⅙"}, {"5/6", "⅚"},
+        {"1/8", "⅛"}, {"3/8", "⅜"}, {"5/8", "⅝"}, {"7/8", "⅞"}
+    };
+
+    auto trim = [](std::string& s) {
+        s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](int ch) { return !std::isspace(ch); }));
+        s.erase(std::find_if(s.rbegin(), s.rend(), [](int ch) { return !std::isspace(ch); }).base(), s.end());
+    };
+
+    auto convert_to_unicode_fractions = [&](std::string& qty) {
+        std::regex mixed_number_pattern(R"((\b\d+)\s+(\d/\d)\b)");
+        std::smatch match;
+        while (std::regex_search(qty, match, mixed_number_pattern)) {
+            std::string whole = match[1];
+            std::string frac = match[2];
+            auto it = ascii_to_unicode.find(frac);
+            if (it != ascii_to_unicode.end()) {
+                qty.replace(match.position(0), match.length(0), whole + it->second);
+            } else {
+                break;
+            }
+        }
+        for (const auto& [ascii_frac, unicode_frac] : ascii_to_unicode) {
+            std::regex standalone_frac(R"(\b)" + ascii_frac + R"(\b)");
+            qty = std::regex_replace(qty, standalone_frac, unicode_frac);
+        }
+    };
+
+    for (Recipe& recipe : target) {
+        for (Ingredient& ing : recipe.ingredients) {
+            trim(ing.quantity);
+            trim(ing.unit);
+            trim(ing.name);
+            convert_to_unicode_fractions(ing.quantity);
+            for (const auto& [key, replacement] : unit_map) {
+                std::regex pattern("\\b" + key + "\\b", std::regex_constants::icase);
+                ing.unit = std::regex_replace(ing.unit, pattern, replacement);
+            }
+        }
+    }
+}
+
+// Golden corpus: one line per raw ingredient token, tab separated
+
+struct GoldenRow {
+    std::string raw;
+    Ingredient parsed;
+    Ingredient cleaned;
+    std::string canonical;
+    std::string amount; // parse_mixed_fraction of the cleaned quantity, "%.6g"
+};
+
+static std::string escape_field(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '\t') out += "\\t";
+        else if (c == '\n') out += "\\n";
+        else if (c == '\\') out += "\\\\";
+        else out += c;
+    }
+    return out;
+}
+
+static std::string unescape_field(const std::string& s) {
+    std::string out;
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '\\' && i + 1 < s.size()) {
+            char c = s[++i];
+            out += c == 't' ? '\t' : c == 'n' ? '\n' : c;
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+static std::string format_amount(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+    return buffer;
+}
+
+static std::string format_row(const GoldenRow& row) {
+    const std::string fields[] = {
+        row.raw, row.parsed.quantity, row.parsed.unit, row.parsed.name,
+        row.cleaned.quantity, row.cleaned.unit, row.cleaned.name, row.canonical, row.amount
+    };
+    std::string line;
+    for (const std::string& f : fields) {
+        if (!line.empty()) line += '\t';
+        line += escape_field(f);
+    }
+    return line;
+}
+
+static bool parse_row(const std::string& line, GoldenRow& row) {
+    std::vector<std::string> fields;
+    std::string field;
+    std::istringstream iss(line);
+    while (std::getline(iss, field, '\t')) fields.push_back(unescape_field(field));
+    if (!line.empty() && line.back() == '\t') fields.push_back("");
+    if (fields.size() != 9) return false;
+
+    row = GoldenRow{fields[0], {fields[1], fields[3], fields[2]}, {fields[4], fields[6], fields[5]}, fields[7], fields[8]};
+    return true;
+}
+
+// Splits the ingredients column the same way parse_ingredients does
+static std::vector<std::string> split_tokens(const std::string& text) {
+    std::vector<std::string> tokens;
+    std::stringstream ss(text);
+    std::string token;
+    while (std::getline(ss, token, ',')) tokens.push_back(token);
+    return tokens;
+}
+
+static std::vector<std::string> read_ingredient_fields(const std::string& csv_path) {
+    std::vector<std::string> result;
+    std::ifstream file(csv_path);
+    if (!file.is_open()) return result;
+
+    std::vector<std::string> headers = parse_csv_line(read_csv_record(file));
+    int column = -1;
+    for (size_t i = 0; i < headers.size(); ++i)
+        if (headers[i] == "ingredients") column = static_cast<int>(i);
+    if (column < 0) return result;
+
+    while (file) {
+        std::string record = read_csv_record(file);
+        if (record.empty()) continue;
+        std::vector<std::string> fields = parse_csv_line(record);
+        if (static_cast<int>(fields.size()) > column) result.push_back(fields[column]);
+    }
+    return result;
+}
+
+static std::vector<Recipe> make_recipes(const std::vector<std::string>& fields,
+                                        std::vector<Ingredient> (*parse)(const std::string&)) {
+    std::vector<Recipe> result(fields.size());
+    for (size_t i = 0; i < fields.size(); ++i) result[i].ingredients = parse(fields[i]);
+    return result;
+}
+
+static std::vector<Ingredient> flatten(const std::vector<Recipe>& source) {
+    std::vector<Ingredient> result;
+    for (const Recipe& r : source)
+        for (const Ingredient& ing : r.ingredients) result.push_back(ing);
+    return result;
+}
+
+static bool same(const Ingredient& a, const Ingredient& b) {
+    return a.quantity == b.quantity && a.unit == b.unit && a.name == b.name;
+}
+
+static int generate(const std::string& csv_path, const std::string& golden_path) {
+    std::vector<std::string> fields = read_ingredient_fields(csv_path);
+    if (fields.empty()) {
+        std::cerr << "No ingredients read from " << csv_path << "\n";
+        return 1;
+    }
+
+    std::vector<Recipe> parsed = make_recipes(fields, reference_parse_ingredients);
+    std::vector<Recipe> cleaned = parsed;
+    reference_clean_ingredients(cleaned);
+
+    std::ofstream out(golden_path);
+    if (!out.is_open()) {
+        std::cerr << "Failed to open " << golden_path << " for writing\n";
+        return 1;
+    }
+
+    size_t rows = 0;
+    for (size_t r = 0; r < fields.size(); ++r) {
+        std::vector<std::string> tokens = split_tokens(fields[r]);
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            const Ingredient& c = cleaned[r].ingredients[i];
+            GoldenRow row{tokens[i], parsed[r].ingredients[i], c, canonicalize_ingredient(c),
+                          format_amount(parse_mixed_fraction(c.quantity))};
+            out << format_row(row) << "\n";
+            ++rows;
+        }
+    }
+
+    std::cout << "Wrote " << rows << " ingredient rows to " << golden_path << "\n";
+    return 0;
+}
+
+struct Measurement {
+    double seconds = 0.0;
+    uint64_t allocations = 0;
+};
+
+static Measurement measure(const std::function<void()>& body) {
+    uint64_t allocations_before = allocation_count.load();
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto stop = std::chrono::steady_clock::now();
+    return {std::chrono::duration<double>(stop - start).count(), allocation_count.load() - allocations_before};
+}
+
+static void report(const char* label, const Measurement& m, size_t ingredients, size_t bytes, bool ok) {
+    std::printf("%-34s %10.0f ingr/s %9.2f MB/s %8.1f allocs/ingr  %s\n", label,
+                ingredients / m.seconds, bytes / m.seconds / 1e6,
+                static_cast<double>(m.allocations) / ingredients, ok ? "ok" : "DIVERGED");
+}
+
+// Recipe Time box forms and the minute range each must parse to; a false ok means rejected
+static size_t check_time_filters() {
+    struct Case {
+        const char* text;
+        bool ok;
+        TimeFilter::Field field;
+        double min_minutes, max_minutes;
+    };
+    const double unbounded = std::numeric_limits<double>::max();
+    const TimeFilter::Field total = TimeFilter::Field::Total;
+    const Case cases[] = {
+        {"30", true, total, 0, 30},
+        {"<= 30", true, total, 0, 30},
+        {"< 1 hr", true, total, 0, 59},
+        {"> 1 hr", true, total, 61, unbounded},
+        {"= 10", true, total, 10, 10},
+        {"15-45", true, total, 15, 45},
+        {"15 to 45", true, total, 15, 45},
+        {"1-2 hrs", true, total, 60, 120},
+        {"1 to 2 hours", true, total, 60, 120},
+        {"1.5-2h", true, total, 90, 120},
+        {"45 mins - 1 hr", true, total, 45, 60},
+        {"1 hr 30 mins", true, total, 0, 90},
+        {"prep <= 10", true, TimeFilter::Field::Prep, 0, 10},
+        {"cook: 1-2 hrs", true, TimeFilter::Field::Cook, 60, 120},
+        {"soon", false, total, 0, 0},
+    };
+
+    size_t failures = 0;
+    for (const Case& c : cases) {
+        TimeFilter filter;
+        bool ok = parse_time_filter(c.text, filter);
+        bool match = ok == c.ok && (!ok || (filter.field == c.field && filter.min_minutes == c.min_minutes &&
+                                            filter.max_minutes == c.max_minutes));
+        if (match) continue;
+        ++failures;
+        std::cerr << "parse_time_filter(\"" << c.text << "\") gave " << (ok ? "" : "no filter ")
+                  << "[" << filter.min_minutes << ", " << filter.max_minutes << "]\n";
+    }
+    std::printf("%-34s %10zu cases %36s  %s\n", "parse_time_filter", std::size(cases), "",
+                failures == 0 ? "ok" : "DIVERGED");
+    return failures;
+}
+
+static int verify(const std::string& csv_path, const std::string& golden_path) {
+    std::ifstream in(golden_path);
+    if (!in.is_open()) {
+        std::cerr << "Failed to open golden corpus " << golden_path << " (run with --generate first)\n";
+        return 1;
+    }
+
+    std::vector<GoldenRow> golden;
+    std::string line;
+    while (std::getline(in, line)) {
+        GoldenRow row;
+        if (!parse_row(line, row)) {
+            std::cerr << "Malformed golden row " << golden.size() + 1 << "\n";
+            return 1;
+        }
+        golden.push_back(row);
+    }
+
+    std::vector<std::string> fields = read_ingredient_fields(csv_path);
+    size_t bytes = 0;
+    for (const std::string& f : fields) bytes += f.size();
+
+    size_t failures = 0;
+    auto check = [&](const char* what, size_t row, bool ok, const std::string& got) {
+        if (ok) return true;
+        if (failures++ < 10) {
+            std::cerr << what << " diverged on row " << row + 1 << " (" << golden[row].raw << "): got \"" << got << "\"\n";
+        }
+        return false;
+    };
+
+    auto check_parsed = [&](const char* what, const std::vector<Ingredient>& got, bool cleaned_stage) {
+        bool ok = got.size() == golden.size();
+        if (!ok) {
+            std::cerr << what << " produced " << got.size() << " ingredients, expected " << golden.size() << "\n";
+            ++failures;
+            return false;
+        }
+        for (size_t i = 0; i < got.size(); ++i) {
+            const Ingredient& expected = cleaned_stage ? golden[i].cleaned : golden[i].parsed;
+            ok &= check(what, i, same(got[i], expected), got[i].quantity + "|" + got[i].unit + "|" + got[i].name);
+        }
+        return ok;
+    };
+
+    std::printf("%zu recipes, %zu ingredients, %.2f MB of ingredient text, %zu threads\n\n",
+                fields.size(), golden.size(), bytes / 1e6, shared_thread_pool().size() + 1);
+
+    // parse_ingredients
+    std::vector<Recipe> parsed;
+    Measurement m = measure([&] { parsed = make_recipes(fields, reference_parse_ingredients); });
+    report("reference parse", m, golden.size(), bytes, check_parsed("reference parse", flatten(parsed), false));
+
+    clear_ingredient_caches();
+    m = measure([&] { parsed = make_recipes(fields, parse_ingredients); });
+    report("parse_ingredients (cold cache)", m, golden.size(), bytes, check_parsed("parse_ingredients", flatten(parsed), false));
+
+    m = measure([&] { parsed = make_recipes(fields, parse_ingredients); });
+    report("parse_ingredients (warm cache)", m, golden.size(), bytes, check_parsed("parse_ingredients", flatten(parsed), false));
+
+    // clean_all_ingredients_in_recipes, on a fresh copy of the parsed recipes each time
+    std::vector<Recipe> cleaned = parsed;
+    m = measure([&] { reference_clean_ingredients(cleaned); });
+    report("reference clean", m, golden.size(), bytes, check_parsed("reference clean", flatten(cleaned), true));
+
+    bool parallel_default = parallel_enabled();
+    for (bool parallel : {false, true}) {
+        set_parallel_enabled(parallel);
+        clear_ingredient_caches();
+        recipes = parsed;
+        m = measure([] { clean_all_ingredients_in_recipes(); });
+        report(parallel ? "clean_all (parallel, cold cache)" : "clean_all (serial, cold cache)", m,
+               golden.size(), bytes, check_parsed("clean_all", flatten(recipes), true));
+    }
+    recipes = parsed;
+    m = measure([] { clean_all_ingredients_in_recipes(); });
+    report("clean_all (parallel, warm cache)", m, golden.size(), bytes, check_parsed("clean_all", flatten(recipes), true));
+    set_parallel_enabled(parallel_default);
+
+    // parse_mixed_fraction and canonicalization of the cleaned ingredients
+    std::vector<Ingredient> flat = flatten(recipes);
+    std::vector<std::string> amounts(flat.size());
+    m = measure([&] {
+        for (size_t i = 0; i < flat.size(); ++i) amounts[i] = format_amount(parse_mixed_fraction(flat[i].quantity));
+    });
+    bool ok = true;
+    for (size_t i = 0; i < flat.size(); ++i) ok &= check("parse_mixed_fraction", i, amounts[i] == golden[i].amount, amounts[i]);
+    report("parse_mixed_fraction", m, golden.size(), bytes, ok);
+
+    std::vector<std::string> canonical(flat.size());
+    m = measure([&] {
+        for (size_t i = 0; i < flat.size(); ++i) canonical[i] = canonicalize_ingredient(flat[i]);
+    });
+    ok = true;
+    for (size_t i = 0; i < flat.size(); ++i) ok &= check("canonicalize_ingredient", i, canonical[i] == golden[i].canonical, canonical[i]);
+    report("canonicalize_ingredient", m, golden.size(), bytes, ok);
+
+    failures += check_time_filters();
+
+    if (failures > 0) {
+        std::cerr << "\n" << failures << " mismatches against " << golden_path << "\n";
+        return 1;
+    }
+    std::cout << "\nAll implementations match the golden corpus\n";
+    return 0;
+}
+
+// Posting list kernels
+
+// Sorted ids over [0, universe) with each id present with the given probability
+static std::vector<uint32_t> synthetic_postings(double density, uint32_t universe, std::mt19937& rng) {
+    std::vector<uint32_t> ids;
+    if (density <= 0.0) return ids;
+    std::geometric_distribution<uint32_t> gap(std::min(density, 1.0));
+    for (uint64_t id = gap(rng); id < universe; id += 1 + gap(rng)) ids.push_back(static_cast<uint32_t>(id));
+    return ids;
+}
+
+// Average microseconds per call over enough repetitions to fill a few milliseconds
+static double time_us(const std::function<void()>& body) {
+    size_t reps = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    do {
+        body();
+        ++reps;
+        elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < 20000.0 && reps < 100000);
+    return elapsed / reps;
+}
+
+static int postings_benchmark(const std::string& csv_path) {
+    load_recipes(csv_path);
+    if (recipes.empty()) return 1;
+
+    size_t index_bytes = searchIndex.postings_memory_bytes(), index_count = searchIndex.postings_count();
+    std::printf("\nSearch index: %zu postings in %zu bytes (%.2f bytes/posting, 4.00 uncompressed)\n",
+                index_count, index_bytes, static_cast<double>(index_bytes) / index_count);
+
+    // Scale every ingredient's document frequency from the corpus up to a million recipes
+    const uint32_t universe = 1000000;
+    std::mt19937 rng(42);
+    std::vector<std::vector<uint32_t>> lists;
+    for (const CompressedPostings& postings : searchIndex.ingredient_postings)
+        lists.push_back(synthetic_postings(static_cast<double>(postings.size()) / recipes.size(), universe, rng));
+
+    size_t failures = 0, raw_count = 0, packed_bytes = 0;
+    std::vector<CompressedPostings> packed;
+    for (const std::vector<uint32_t>& list : lists) {
+        packed.emplace_back(list);
+        raw_count += list.size();
+        packed_bytes += packed.back().memory_bytes();
+        if (packed.back().decode() != list) ++failures;
+    }
+    std::printf("Scaled to %u recipes: %zu postings in %zu bytes (%.2f bytes/posting)\n\n",
+                universe, raw_count, packed_bytes, static_cast<double>(packed_bytes) / raw_count);
+
+    // Frequent x frequent, frequent x mid, frequent x rare and mid x rare terms
+    const size_t vocab = lists.size();
+    const std::vector<std::pair<size_t, size_t>> pairs = {
+        {0, 1}, {0, std::min<size_t>(20, vocab - 1)}, {0, vocab / 2}, {std::min<size_t>(20, vocab - 1), vocab / 2}};
+
+    std::printf("%-31s %9s %10s %10s %10s %10s | %-8s %10s %10s %10s\n", "pair (sizes)", "result",
+                "merge us", "gallop us", "simd us", "packed us", "union", "merge us", "gallop us", "simd us");
+    std::vector<uint32_t> expected, out;
+    for (const auto& [x, y] : pairs) {
+        const std::vector<uint32_t>& a = lists[x];
+        const std::vector<uint32_t>& b = lists[y];
+        const std::vector<uint32_t>& small = a.size() <= b.size() ? a : b;
+        const std::vector<uint32_t>& large = a.size() <= b.size() ? b : a;
+        const CompressedPostings& packed_large = a.size() <= b.size() ? packed[y] : packed[x];
+
+        intersect_merge(a.data(), a.size(), b.data(), b.size(), expected);
+        auto agrees = [&](const char* kernel) {
+            if (out == expected) return;
+            std::cerr << kernel << " diverged on terms " << x << " and " << y << "\n";
+            ++failures;
+        };
+
+        double merge = time_us([&] { intersect_merge(a.data(), a.size(), b.data(), b.size(), out); });
+        double gallop = time_us([&] { intersect_galloping(small.data(), small.size(), large.data(), large.size(), out); });
+        agrees("intersect_galloping");
+        double simd = time_us([&] { intersect_simd(a.data(), a.size(), b.data(), b.size(), out); });
+        agrees("intersect_simd");
+        double compressed = time_us([&] { out = packed_large.intersect(small); });
+        agrees("CompressedPostings::intersect");
+
+        std::vector<uint32_t> expected_union;
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected_union));
+        auto union_agrees = [&](const char* kernel) {
+            if (out == expected_union) return;
+            std::cerr << kernel << " diverged on terms " << x << " and " << y << "\n";
+            ++failures;
+        };
+        double union_merged = time_us([&] { union_merge(a.data(), a.size(), b.data(), b.size(), out); });
+        union_agrees("union_merge");
+        double union_gallop = time_us([&] { union_galloping(small.data(), small.size(), large.data(), large.size(), out); });
+        union_agrees("union_galloping");
+        double union_vector = time_us([&] { union_simd(a.data(), a.size(), b.data(), b.size(), out); });
+        union_agrees("union_simd");
+        union_sorted(a, b, out);
+        union_agrees("union_sorted");
+
+        std::string label = std::to_string(x) + "x" + std::to_string(y);
+        std::string sizes = "(" + std::to_string(a.size()) + "," + std::to_string(b.size()) + ")";
+        std::printf("%-8s %-22s %9zu %10.1f %10.1f %10.1f %10.1f | %8zu %10.1f %10.1f %10.1f\n", label.c_str(),
+                    sizes.c_str(), expected.size(), merge, gallop, simd, compressed, expected_union.size(),
+                    union_merged, union_gallop, union_vector);
+    }
+
+    if (failures > 0) {
+        std::cerr << "\n" << failures << " posting list mismatches\n";
+        return 1;
+    }
+    std::cout << "\nAll posting list kernels agree\n";
+    return 0;
+}
+
+// Near-duplicate report
+
+static constexpr float kDuplicateJaccard = 0.8f;
+
+static int near_duplicates_report(const std::string& csv_path) {
+    load_recipes(csv_path);
+    if (recipes.empty()) return 1;
+
+    const MinHashIndex& index = searchIndex.similarity;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<DuplicatePair> found = index.near_duplicates(kDuplicateJaccard);
+    double lsh_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Every pair, compared exactly, as the reference for what LSH should have found
+    start = std::chrono::steady_clock::now();
+    std::vector<std::vector<uint32_t>> sets(recipes.size());
+    for (size_t i = 0; i < recipes.size(); ++i) {
+        for (const Ingredient& ingredient : recipes[i].ingredients)
+            if (ingredient.canonical_id != kNoIngredientId) sets[i].push_back(ingredient.canonical_id);
+        std::sort(sets[i].begin(), sets[i].end());
+        sets[i].erase(std::unique(sets[i].begin(), sets[i].end()), sets[i].end());
+    }
+    size_t expected = 0;
+    for (size_t a = 0; a < sets.size(); ++a) {
+        for (size_t b = a + 1; b < sets.size(); ++b) {
+            if (sets[a].empty() || sets[b].empty()) continue;
+            std::vector<uint32_t> shared;
+            std::set_intersection(sets[a].begin(), sets[a].end(), sets[b].begin(), sets[b].end(),
+                                  std::back_inserter(shared));
+            size_t total = sets[a].size() + sets[b].size() - shared.size();
+            if (static_cast<float>(shared.size()) / total >= kDuplicateJaccard) ++expected;
+        }
+    }
+    double brute_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("\n%-40s %-40s %7s\n", "recipe", "near duplicate", "jaccard");
+    for (const DuplicatePair& pair : found)
+        std::printf("%-40.40s %-40.40s %7.2f\n", recipes[pair.first].name.c_str(),
+                    recipes[pair.second].name.c_str(), pair.jaccard);
+
+    size_t all_pairs = recipes.size() * (recipes.size() - 1) / 2;
+    std::printf("\n%zu pairs at Jaccard >= %.2f (%zu by all-pairs comparison)\n", found.size(),
+                kDuplicateJaccard, expected);
+    std::printf("LSH compared %zu of %zu pairs in %.1f ms; all pairs took %.1f ms\n",
+                index.candidate_pairs(), all_pairs, lsh_ms, brute_ms);
+    return 0;
+}
+
+// Vector search
+
+static int vectors_benchmark(const std::string& csv_path) {
+    load_recipes(csv_path);
+    if (recipes.empty()) return 1;
+    VectorIndex& index = searchIndex.vectors;
+
+    auto ms_since = [](auto start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    auto start = std::chrono::steady_clock::now();
+    index.build();
+    double build_ms = ms_since(start);
+    const std::string path = "bench_vectors.hnsw";
+    start = std::chrono::steady_clock::now();
+    bool saved = index.save(path);
+    double save_ms = ms_since(start);
+    start = std::chrono::steady_clock::now();
+    bool loaded = saved && index.load(path);
+    double load_ms = ms_since(start);
+    std::remove(path.c_str());
+    if (!loaded) {
+        std::cerr << "Could not save and reload the vector index\n";
+        return 1;
+    }
+    std::printf("\nVector index: %zu recipes, %zu bytes; build %.1f ms, save %.2f ms, load %.2f ms\n",
+                index.size(), index.memory_bytes(), build_ms, save_ms, load_ms);
+
+    // Every recipe name as a query, plus a few free-text descriptions
+    std::vector<std::string> queries = {"creamy garlic pasta with mushrooms", "spicy chicken curry with rice",
+                                        "chocolate cake for a birthday", "quick vegetable soup",
+                                        "grilled fish with lemon and herbs"};
+    for (const Recipe& r : recipes) queries.push_back(r.name);
+
+    const size_t k = 10;
+    const std::vector<char> everything;
+    size_t found = 0, expected = 0;
+    double graph_us = 0.0, exact_us = 0.0;
+    for (const std::string& query : queries) {
+        std::vector<VectorMatch> approximate, exact;
+        graph_us += time_us([&] { approximate = index.nearest(query, k, everything); });
+        exact_us += time_us([&] { exact = index.nearest_exact(query, k, everything); });
+        expected += exact.size();
+        for (const VectorMatch& e : exact) {
+            found += std::any_of(approximate.begin(), approximate.end(),
+                                 [&](const VectorMatch& a) { return a.recipe_id == e.recipe_id; });
+        }
+    }
+
+    for (size_t q = 0; q < 5; ++q) {
+        std::printf("\n\"%s\"\n", queries[q].c_str());
+        for (const VectorMatch& m : index.nearest(queries[q], 3, everything))
+            std::printf("  %.2f  %s\n", m.similarity, recipes[m.recipe_id].name.c_str());
+    }
+    std::printf("\n%zu queries, k = %zu: recall %.3f; graph %.1f us/query, exact %.1f us/query\n", queries.size(), k,
+                expected ? static_cast<double>(found) / expected : 1.0, graph_us / queries.size(),
+                exact_us / queries.size());
+    return 0;
+}
+
+// Substring kernels
+
+static int substring_benchmark(const std::string& csv_path) {
+    load_recipes(csv_path);
+    if (recipes.empty()) return 1;
+
+    // One find per key, the way the filters scanned before the keys were packed
+    auto per_key = [](const std::string& needle, bool ingredients) {
+        std::vector<uint32_t> ids;
+        for (uint32_t r = 0; r < recipes.size(); ++r) {
+            bool found = ingredients ? std::any_of(recipes[r].ingredients.begin(), recipes[r].ingredients.end(),
+                                                   [&](const Ingredient& ing) { return ing.name_key.find(needle) != std::string::npos; })
+                                     : recipes[r].name_key.find(needle) != std::string::npos;
+            if (found) ids.push_back(r);
+        }
+        return ids;
+    };
+
+    const std::vector<std::pair<std::string, bool>> queries = {
+        {"a", false}, {"ch", false}, {"pie", false}, {"chicken", false}, {"chocolate chip", false},
+        {"salad", false}, {"zzz", false}, {"melted", true}, {"chopped", true}, {"o", true},
+        {"freshly ground", true}, {"sliced", true}, {"all-purpose flour", true}};
+    const std::pair<const char*, SubstringKernel> kernels[] = {
+        {"scalar", SubstringKernel::Scalar}, {"sse2", SubstringKernel::Sse2}, {"avx2", SubstringKernel::Avx2}};
+
+    // Names are answered by the n-gram index; they are packed here only to compare against it
+    PackedKeys name_keys;
+    for (uint32_t r = 0; r < recipes.size(); ++r) name_keys.add(r, recipes[r].name_key);
+
+    std::printf("\nPacked keys: %zu names, %zu ingredient lines (%zu bytes); best kernel %s\n",
+                name_keys.key_count(), searchIndex.ingredient_keys.key_count(),
+                searchIndex.ingredient_keys.memory_bytes(), kernels[static_cast<int>(best_substring_kernel())].first);
+    std::printf("\n%-24s %7s %10s %10s %10s %10s %10s\n", "needle", "result", "find us", "scalar us", "sse2 us",
+                "avx2 us", "ngram us");
+
+    size_t failures = 0;
+    std::vector<uint32_t> out;
+    for (const auto& [needle, ingredients] : queries) {
+        const PackedKeys& keys = ingredients ? searchIndex.ingredient_keys : name_keys;
+        std::vector<uint32_t> expected = per_key(needle, ingredients);
+        double find_us = time_us([&] { out = per_key(needle, ingredients); });
+
+        double kernel_us[3] = {0.0, 0.0, 0.0};
+        for (int k = 0; k < 3; ++k) {
+            if (!substring_kernel_supported(kernels[k].second)) continue;
+            kernel_us[k] = time_us([&] { out = keys.find(needle, kernels[k].second); });
+            if (out != expected) {
+                std::cerr << kernels[k].first << " kernel diverged on \"" << needle << "\"\n";
+                ++failures;
+            }
+        }
+        char ngram[16] = "-";
+        if (!ingredients) {
+            std::snprintf(ngram, sizeof(ngram), "%.1f",
+                          time_us([&] { out = searchIndex.recipes_with_name_substring(needle); }));
+            if (out != expected) {
+                std::cerr << "name index diverged on \"" << needle << "\"\n";
+                ++failures;
+            }
+        }
+
+        std::string label = (ingredients ? "ing:" : "name:") + needle;
+        std::printf("%-24s %7zu %10.1f %10.1f %10.1f %10.1f %10s\n", label.c_str(), expected.size(), find_us,
+                    kernel_us[0], kernel_us[1], kernel_us[2], ngram);
+    }
+
+    if (failures > 0) {
+        std::cerr << "\n" << failures << " substring mismatches\n";
+        return 1;
+    }
+    std::cout << "\nAll substring kernels agree\n";
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    bool generate_mode = false;
+    bool postings_mode = false;
+    bool duplicates_mode = false;
+    bool vectors_mode = false;
+    bool substring_mode = false;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--generate") generate_mode = true;
+        else if (arg == "--postings") postings_mode = true;
+        else if (arg == "--near-duplicates") duplicates_mode = true;
+        else if (arg == "--vectors") vectors_mode = true;
+        else if (arg == "--substring") substring_mode = true;
+        else paths.push_back(arg);
+    }
+
+    std::string csv_path = paths.size() > 0 ? paths[0] : "recipes.csv";
+    std::string golden_path = paths.size() > 1 ? paths[1] : "bench/golden_ingredients.tsv";
+
+    if (postings_mode) return postings_benchmark(csv_path);
+    if (duplicates_mode) return near_duplicates_report(csv_path);
+    if (vectors_mode) return vectors_benchmark(csv_path);
+    if (substring_mode) return substring_benchmark(csv_path);
+    return generate_mode ? generate(csv_path, golden_path) : verify(csv_path, golden_path);
+}
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cmath>
+
+#include "bm25.hpp"
+#include "symSpell.hpp"
+
+void Bm25Index::clear() {
+    term_ids.clear();
+    for (int f = 0; f < kFieldCount; ++f) {
+        postings[f].clear();
+        lengths[f].clear();
+        total_length[f] = 0;
+    }
+    doc_count = 0;
+}
+
+void Bm25Index::add_document(uint32_t recipe_id, const std::array<std::string, kFieldCount>& fields) {
+    for (int f = 0; f < kFieldCount; ++f) {
+        std::vector<std::string> words = split_vocabulary_words(fields[f]);
+        lengths[f].resize(recipe_id + 1, 0);
+        lengths[f][recipe_id] = static_cast<uint32_t>(words.size());
+        total_length[f] += words.size();
+
+        // Term frequencies for this field; each term's posting list gets one entry per document
+        std::sort(words.begin(), words.end());
+        for (size_t i = 0; i < words.size();) {
+            size_t j = i;
+            while (j < words.size() && words[j] == words[i]) ++j;
+
+            auto [it, added] = term_ids.emplace(words[i], static_cast<uint32_t>(term_ids.size()));
+            for (auto& field_postings : postings) {
+                if (field_postings.size() <= it->second) field_postings.resize(it->second + 1);
+            }
+            postings[f][it->second].push_back({recipe_id, static_cast<uint32_t>(j - i)});
+            i = j;
+        }
+    }
+    doc_count = std::max(doc_count, recipe_id + 1);
+}
+
+uint32_t Bm25Index::document_frequency(Field field, const std::string& term) const {
+    auto it = term_ids.find(term);
+    return it == term_ids.end() ? 0 : static_cast<uint32_t>(postings[field][it->second].size());
+}
+
+std::vector<ScoredRecipe> Bm25Index::top_k(const std::vector<std::string>& terms, size_t k,
+                                           const std::vector<char>& allowed) const {
+    std::vector<ScoredRecipe> top;
+    if (doc_count == 0 || k == 0) return top;
+
+    std::vector<std::string> unique_terms = terms;
+    std::sort(unique_terms.begin(), unique_terms.end());
+    unique_terms.erase(std::unique(unique_terms.begin(), unique_terms.end()), unique_terms.end());
+
+    // Term-at-a-time accumulation into a dense score array
+    std::vector<float> scores(doc_count, 0.0f);
+    std::vector<uint32_t> touched;
+    for (const std::string& term : unique_terms) {
+        auto it = term_ids.find(term);
+        if (it == term_ids.end()) continue;
+
+        for (int f = 0; f < kFieldCount; ++f) {
+            const std::vector<Posting>& list = postings[f][it->second];
+            if (list.empty()) continue;
+
+            const double df = static_cast<double>(list.size());
+            const float idf = static_cast<float>(std::log(1.0 + (doc_count - df + 0.5) / (df + 0.5)));
+            const float avg_length = static_cast<float>(total_length[f]) / doc_count;
+            for (const Posting& p : list) {
+                if (!allowed.empty() && !allowed[p.recipe_id]) continue;
+                const float tf = static_cast<float>(p.tf);
+                const float norm = k1 * (1.0f - b + b * lengths[f][p.recipe_id] / std::max(avg_length, 1.0f));
+                if (scores[p.recipe_id] == 0.0f) touched.push_back(p.recipe_id);
+                scores[p.recipe_id] += weights[f] * idf * tf * (k1 + 1.0f) / (tf + norm);
+            }
+        }
+    }
+
+    // Bounded min-heap: the weakest of the current top k sits at the front
+    auto better = [](const ScoredRecipe& a, const ScoredRecipe& c) {
+        if (a.score != c.score) return a.score > c.score;
+        return a.recipe_id < c.recipe_id;
+    };
+    top.reserve(std::min(k, touched.size()));
+    for (uint32_t r : touched) {
+        ScoredRecipe candidate{r, scores[r]};
+        if (top.size() < k) {
+            top.push_back(candidate);
+            std::push_heap(top.begin(), top.end(), better);
+        } else if (better(candidate, top.front())) {
+            std::pop_heap(top.begin(), top.end(), better);
+            top.back() = candidate;
+            std::push_heap(top.begin(), top.end(), better);
+        }
+    }
+    std::sort_heap(top.begin(), top.end(), better);
+    return top;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ScoredRecipe {
+    uint32_t recipe_id;
+    float score;
+};
+
+// BM25 over the name, ingredient and directions text of every recipe. Each field keeps its own
+// term frequencies, lengths and document frequencies; a recipe's score is the weighted sum of
+// its per-field BM25 scores. Everything is updated in place as documents are added, so the
+// statistics stay exact for recipes appended at runtime.
+class Bm25Index {
+public:
+    enum Field { Name, Ingredients, Directions, kFieldCount };
+
+    float k1 = 1.2f;
+    float b = 0.75f;
+    std::array<float, kFieldCount> weights{{3.0f, 2.0f, 1.0f}};
+
+    void clear();
+
+    // Documents must be added in recipe id order
+    void add_document(uint32_t recipe_id, const std::array<std::string, kFieldCount>& fields);
+
+    // The k highest-scoring recipes for the query terms, best first. allowed (by recipe id)
+    // restricts the candidates when not empty.
+    std::vector<ScoredRecipe> top_k(const std::vector<std::string>& terms, size_t k,
+                                    const std::vector<char>& allowed) const;
+
+    size_t document_count() const { return doc_count; }
+    // Number of recipes whose field contains the term
+    uint32_t document_frequency(Field field, const std::string& term) const;
+
+private:
+    struct Posting {
+        uint32_t recipe_id;
+        uint32_t tf;
+    };
+
+    std::unordered_map<std::string, uint32_t> term_ids;
+    std::array<std::vector<std::vector<Posting>>, kFieldCount> postings; // [field][term id]
+    std::array<std::vector<uint32_t>, kFieldCount> lengths;              // [field][recipe id]
+    std::array<uint64_t, kFieldCount> total_length{};
+    uint32_t doc_count = 0;
+};
@@ -0,0 +1,113 @@
+#include <cstdint>
+
+#include "caseFold.hpp"
+
+// Length of the UTF-8 sequence at text[i] and its code point; 0 when it is not well formed
+static size_t decode(std::string_view text, size_t i, uint32_t& cp) {
+    unsigned char lead = static_cast<unsigned char>(text[i]);
+    size_t length = lead < 0xC2 ? 0 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : lead < 0xF5 ? 4 : 0;
+    if (length == 0 || i + length > text.size()) return 0;
+    cp = lead & (0x7F >> length);
+    for (size_t k = 1; k < length; ++k) {
+        unsigned char c = static_cast<unsigned char>(text[i + k]);
+        if ((c & 0xC0) != 0x80) return 0;
+        cp = (cp << 6) | (c & 0x3F);
+    }
+    // Reject overlong forms and surrogates
+    static const uint32_t kMinimum[5] = {0, 0, 0x80, 0x800, 0x10000};
+    if (cp < kMinimum[length] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return 0;
+    return length;
+}
+
+static void encode(uint32_t cp, std::string& out) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+static bool between(uint32_t cp, uint32_t first, uint32_t last) { return cp >= first && cp <= last; }
+
+// Simple (one to one) folds from CaseFolding.txt for the covered blocks. Most of Latin Extended
+// and the Cyrillic extensions alternate upper and lower case, uppercase on the even code point.
+static uint32_t fold_code_point(uint32_t cp) {
+    if (between(cp, 0xC0, 0xDE) && cp != 0xD7) return cp + 0x20;
+    if (cp == 0xB5) return 0x3BC;  // micro sign -> mu
+    if (between(cp, 0x100, 0x12F) || between(cp, 0x132, 0x137) || between(cp, 0x14A, 0x177))
+        return cp | 1;
+    if (between(cp, 0x139, 0x148) || between(cp, 0x179, 0x17E)) return cp % 2 ? cp + 1 : cp;
+    if (cp == 0x178) return 0xFF;
+    if (cp == 0x17F) return 's';   // long s
+    if (cp == 0x386) return 0x3AC;
+    if (between(cp, 0x388, 0x38A)) return cp + 37;
+    if (cp == 0x38C) return 0x3CC;
+    if (between(cp, 0x38E, 0x38F)) return cp + 63;
+    if (between(cp, 0x391, 0x3AB) && cp != 0x3A2) return cp + 0x20;
+    if (cp == 0x3C2) return 0x3C3; // final sigma
+    if (between(cp, 0x400, 0x40F)) return cp + 0x50;
+    if (between(cp, 0x410, 0x42F)) return cp + 0x20;
+    if (between(cp, 0x460, 0x481) || between(cp, 0x48A, 0x4BF)) return cp | 1;
+    if (between(cp, 0x1E00, 0x1E95) || between(cp, 0x1EA0, 0x1EFF)) return cp | 1;
+    if (cp == 0x212A) return 'k';  // Kelvin sign
+    if (cp == 0x212B) return 0xE5; // Angstrom sign
+    if (between(cp, 0xFF21, 0xFF3A)) return cp + 0x20;
+    return cp;
+}
+
+std::string fold_case(std::string_view text) {
+    std::string folded;
+    folded.reserve(text.size());
+    for (size_t i = 0; i < text.size();) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c < 0x80) {
+            folded += static_cast<char>(c >= 'A' && c <= 'Z' ? c + 0x20 : c);
+            ++i;
+            continue;
+        }
+        uint32_t cp = 0;
+        size_t length = decode(text, i, cp);
+        if (length == 0) {
+            folded += static_cast<char>(c);
+            ++i;
+            continue;
+        }
+        i += length;
+        // Full folds that expand
+        if (cp == 0xDF || cp == 0x1E9E) {
+            folded += "ss";
+        } else if (cp == 0x130) {
+            folded += "i\xCC\x87"; // i + combining dot above
+        } else {
+            encode(fold_code_point(cp), folded);
+        }
+    }
+    return folded;
+}
+
+std::string search_key(std::string_view text) {
+    auto space_at_front = [&](std::string_view s) -> size_t {
+        if (s.empty()) return 0;
+        if (s[0] == ' ' || (s[0] >= '\t' && s[0] <= '\r')) return 1;
+        return s.size() >= 2 && s[0] == '\xC2' && s[1] == '\xA0' ? 2 : 0;
+    };
+    auto space_at_back = [&](std::string_view s) -> size_t {
+        if (s.empty()) return 0;
+        char last = s.back();
+        if (last == ' ' || (last >= '\t' && last <= '\r')) return 1;
+        return s.size() >= 2 && s[s.size() - 2] == '\xC2' && last == '\xA0' ? 2 : 0;
+    };
+    while (size_t n = space_at_front(text)) text.remove_prefix(n);
+    while (size_t n = space_at_back(text)) text.remove_suffix(n);
+    return fold_case(text);
+}
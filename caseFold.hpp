@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+// Unicode case folding of UTF-8 text for case-insensitive matching. Covers ASCII, Latin-1,
+// Latin Extended-A and Additional, Greek, Cyrillic and fullwidth Latin, including the folds that
+// change length ("ß" -> "ss"). Bytes that are not valid UTF-8 are copied unchanged.
+std::string fold_case(std::string_view text);
+
+// fold_case with leading and trailing whitespace (ASCII and no-break space) removed: the form
+// every search key and typed filter is compared in
+std::string search_key(std::string_view text);
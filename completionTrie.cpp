@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <map>
+#include <queue>
+
+#include "completionTrie.hpp"
+
+void CompletionTrie::clear() {
+    nodes.clear();
+    labels.clear();
+    texts.clear();
+    entry_weights.clear();
+}
+
+void CompletionTrie::build(std::vector<std::pair<std::string, std::string>> keyed_texts,
+                           const std::vector<uint32_t>& weights) {
+    clear();
+
+    // Sort and merge the keys; entry ids follow key order
+    std::map<std::string, std::pair<std::string, uint32_t>> merged;
+    for (size_t i = 0; i < keyed_texts.size(); ++i) {
+        if (keyed_texts[i].first.empty()) continue;
+        auto [it, added] = merged.emplace(std::move(keyed_texts[i].first), std::make_pair(std::move(keyed_texts[i].second), 0u));
+        it->second.second += weights[i];
+    }
+    std::vector<std::string> keys;
+    keys.reserve(merged.size());
+    for (auto& [key, value] : merged) {
+        keys.push_back(key);
+        texts.push_back(std::move(value.first));
+        entry_weights.push_back(value.second);
+    }
+
+    nodes.push_back({0, 0, 0, 0, 0, kNoEntry});
+    nodes[0].max_weight = build_children(0, keys, 0, keys.size(), 0);
+}
+
+// Fills in the children of `node`, whose keys are keys[lo, hi) and share their first `depth` bytes.
+// Returns the subtree's max weight.
+uint32_t CompletionTrie::build_children(uint32_t node, const std::vector<std::string>& keys, size_t lo, size_t hi,
+                                        size_t depth) {
+    uint32_t best = 0;
+    // Sorted order puts a key equal to the shared prefix first
+    if (lo < hi && keys[lo].size() == depth) {
+        nodes[node].entry = static_cast<uint32_t>(lo);
+        best = entry_weights[lo];
+        ++lo;
+    }
+
+    // One child per distinct next byte; the edge runs to the group's longest common prefix
+    std::vector<std::pair<size_t, size_t>> groups;
+    for (size_t start = lo; start < hi;) {
+        size_t end = start + 1;
+        while (end < hi && keys[end][depth] == keys[start][depth]) ++end;
+        groups.emplace_back(start, end);
+        start = end;
+    }
+
+    const uint32_t first = static_cast<uint32_t>(nodes.size());
+    nodes[node].first_child = first;
+    nodes[node].child_count = static_cast<uint32_t>(groups.size());
+    nodes.resize(nodes.size() + groups.size());
+
+    for (size_t g = 0; g < groups.size(); ++g) {
+        const std::string& a = keys[groups[g].first];
+        const std::string& b = keys[groups[g].second - 1];
+        size_t common = depth;
+        while (common < a.size() && common < b.size() && a[common] == b[common]) ++common;
+
+        Node& child = nodes[first + g];
+        child = {static_cast<uint32_t>(labels.size()), static_cast<uint32_t>(common - depth), 0, 0, 0, kNoEntry};
+        labels.append(a, depth, common - depth);
+        uint32_t weight = build_children(first + static_cast<uint32_t>(g), keys, groups[g].first, groups[g].second, common);
+        nodes[first + g].max_weight = weight;
+        best = std::max(best, weight);
+    }
+    return best;
+}
+
+std::vector<Completion> CompletionTrie::complete(const std::string& lowered_prefix, size_t max_results) const {
+    std::vector<Completion> out;
+    if (nodes.empty() || max_results == 0) return out;
+
+    // Walk down to the node whose subtree holds every key with the prefix
+    uint32_t node = 0;
+    size_t matched = 0;
+    while (matched < lowered_prefix.size()) {
+        const Node& parent = nodes[node];
+        const Node* begin = nodes.data() + parent.first_child;
+        const Node* end = begin + parent.child_count;
+        const unsigned char next = lowered_prefix[matched];
+        const Node* child = std::lower_bound(begin, end, next, [&](const Node& n, unsigned char c) {
+            return static_cast<unsigned char>(labels[n.label_offset]) < c;
+        });
+        if (child == end || static_cast<unsigned char>(labels[child->label_offset]) != next) return out;
+
+        size_t take = std::min<size_t>(child->label_length, lowered_prefix.size() - matched);
+        if (labels.compare(child->label_offset, take, lowered_prefix, matched, take) != 0) return out;
+        matched += take;
+        node = static_cast<uint32_t>(child - nodes.data());
+    }
+
+    // Best-first: a subtree is expanded only when its max weight beats everything still queued
+    struct Item {
+        uint32_t weight;
+        uint32_t index;   // node, or entry when is_entry
+        bool is_entry;
+        bool operator<(const Item& other) const {
+            if (weight != other.weight) return weight < other.weight;
+            if (is_entry != other.is_entry) return !is_entry; // entries before subtrees of equal weight
+            return index > other.index;                       // then key order
+        }
+    };
+    std::priority_queue<Item> queue;
+    queue.push({nodes[node].max_weight, node, false});
+    while (!queue.empty() && out.size() < max_results) {
+        Item item = queue.top();
+        queue.pop();
+        if (item.is_entry) {
+            out.push_back({&texts[item.index], item.weight});
+            continue;
+        }
+        const Node& n = nodes[item.index];
+        if (n.entry != kNoEntry) queue.push({entry_weights[n.entry], n.entry, true});
+        for (uint32_t c = n.first_child; c < n.first_child + n.child_count; ++c)
+            queue.push({nodes[c].max_weight, c, false});
+    }
+    return out;
+}
+
+size_t CompletionTrie::memory_bytes() const {
+    size_t bytes = nodes.capacity() * sizeof(Node) + labels.capacity() + entry_weights.capacity() * sizeof(uint32_t);
+    for (const std::string& text : texts) bytes += sizeof(std::string) + text.capacity();
+    return bytes;
+}
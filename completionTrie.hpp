@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct Completion {
+    const std::string* text; // display text, owned by the trie
+    uint32_t weight;
+};
+
+// Weighted prefix completion over a static vocabulary. Keys are stored in a radix tree flattened
+// into arrays: each node owns a run of edge label bytes, a contiguous block of children sorted by
+// first byte, and the largest weight anywhere below it, so the best completions of a prefix are
+// found best-first without visiting subtrees that cannot beat the ones already found.
+class CompletionTrie {
+public:
+    // (key, display text, weight); keys must be lowercase. Entries with equal keys are merged:
+    // their weights add up and the first display text is kept.
+    void build(std::vector<std::pair<std::string, std::string>> keyed_texts, const std::vector<uint32_t>& weights);
+    void clear();
+
+    // Highest-weighted entries whose key starts with lowered_prefix, best first, at most max_results
+    std::vector<Completion> complete(const std::string& lowered_prefix, size_t max_results) const;
+
+    size_t size() const { return texts.size(); }
+    size_t memory_bytes() const;
+
+private:
+    static constexpr uint32_t kNoEntry = UINT32_MAX;
+
+    struct Node {
+        uint32_t label_offset;  // edge label from the parent, in `labels`
+        uint32_t label_length;
+        uint32_t first_child;   // children are nodes[first_child, first_child + child_count)
+        uint32_t child_count;
+        uint32_t max_weight;    // best weight in this subtree
+        uint32_t entry;         // entry ending exactly here, or kNoEntry
+    };
+
+    uint32_t build_children(uint32_t node, const std::vector<std::string>& keys, size_t lo, size_t hi, size_t depth);
+
+    std::vector<Node> nodes;
+    std::string labels;
+    std::vector<std::string> texts;   // by entry
+    std::vector<uint32_t> entry_weights;
+};
@@ -11,12 +11,25 @@
 #include <cstdlib>
 #include <map>
 #include <set>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
 
 #include "data.hpp"
+#include "threadPool.hpp"
+#include "memoCache.hpp"
+#include "ingredientDictionary.hpp"
+#include "searchIndex.hpp"
+#include "pantryIndex.hpp"
+#include "caseFold.hpp"
 
 std::vector<Recipe> recipes;
 std::vector<std::string> availableUnits;
 
+static std::atomic<uint64_t> generation{0};
+static std::shared_mutex dataset_lock;
+
 std::string normalize_fractions(const std::string& input) {
     static const std::unordered_map<char, std::string> fraction_map = {
         { L'¼', "1/4" }, { L'½', "1/2" }, { L'¾', "3/4" },
@@ -46,7 +59,7 @@ const std::unordered_map<std::string, std::string> unit_map = {
     {"ml", "mL"}, {"l", "L"}, {"g", "g"}, {"kg", "kg"}, {"lbs", "lbs"}
 };
 
-std::string read_csv_record(std::ifstream& file) {
+std::string read_csv_record(std::istream& file) {
     std::string line, record;
     bool in_quotes = false;
 
@@ -97,46 +110,93 @@ std::vector<std::string> parse_csv_line(const std::string& line) {
     return result;
 }
 
+// Raw ingredient tokens such as " 1 teaspoon salt" repeat across thousands of recipes
+static MemoCache<Ingredient> parse_cache(1 << 16);
+
+// Cleaned (quantity, unit) pairs keyed by the raw pair
+static MemoCache<std::pair<std::string, std::string>> clean_cache(1 << 16);
+
+static Ingredient parse_ingredient_token(const std::string& token) {
+    static const std::regex quantity_pattern(R"([\d¼½¾⅓⅔⅛⅜⅝⅞/\.]+)");
+
+    Ingredient ing;
+    std::istringstream iss(token);
+    std::string word;
+
+    // Step 1: Parse quantity (numbers or unicode fractions)
+    std::string quantity_part;
+    while (iss >> word) {
+        if (std::regex_match(word, quantity_pattern)) {
+            if (!quantity_part.empty())
+                quantity_part += " ";
+            quantity_part += word;
+        } else {
+            break; // stop at first non-number
+        }
+    }
+    ing.quantity = quantity_part;
+
+    std::string unit_candidate = word;
+    std::transform(unit_candidate.begin(), unit_candidate.end(), unit_candidate.begin(), ::tolower);
+    ing.unit = unit_candidate;
+
+    // Step 2: Append remaining words to name
+    while (iss >> word) {
+        ing.name += word + " ";
+    }
+
+    // Trim trailing space from name
+    ing.name.erase(ing.name.find_last_not_of(" \t\n\r\f\v") + 1);
+
+    return ing;
+}
+
 std::vector<Ingredient> parse_ingredients(const std::string& ingredients_text) {
     std::vector<Ingredient> result;
     std::stringstream ss(ingredients_text);
     std::string token;
 
     while (std::getline(ss, token, ',')) {
-        Ingredient ing;
-        std::istringstream iss(token);
-        std::string word;
-
-        // Step 1: Parse quantity (numbers or unicode fractions)
-        std::string quantity_part;
-        while (iss >> word) {
-            if (std::regex_match(word, std::regex(R"([\d¼½¾⅓⅔⅛⅜⅝⅞/\.]+)"))) {
-                if (!quantity_part.empty())
-                    quantity_part += " ";
-                quantity_part += word;
-            } else {
-                break; // stop at first non-number
-            }
-        }
-        ing.quantity = quantity_part;
+        result.push_back(parse_cache.get_or_compute(token, parse_ingredient_token));
+    }
 
-	std::string unit_candidate = word;
-	std::transform(unit_candidate.begin(), unit_candidate.end(), unit_candidate.begin(), ::tolower);
-	ing.unit = unit_candidate;
+    return result;
+}
 
-        // Step 2: Append remaining words to name
-        std::string rest;
-        while (iss >> word) {
-            ing.name += word + " ";
+int parse_duration_minutes(const std::string& text) {
+    std::istringstream iss(text);
+    std::string word;
+    double minutes = 0.0, pending = -1.0;
+    bool found = false;
+
+    // Walk "<number> <unit>" pairs; the unit may also be glued to the number ("90m", "1h")
+    while (iss >> word) {
+        size_t digits = 0;
+        while (digits < word.size() && (std::isdigit(static_cast<unsigned char>(word[digits])) || word[digits] == '.')) ++digits;
+        std::string unit = word.substr(digits);
+        if (digits > 0) {
+            if (pending >= 0.0) { minutes += pending; found = true; } // previous number had no unit
+            pending = std::atof(word.substr(0, digits).c_str());
+            if (unit.empty()) continue;
         }
-
-        // Trim trailing space from name
-        ing.name.erase(ing.name.find_last_not_of(" \t\n\r\f\v") + 1);
-
-        result.push_back(ing);
+        if (pending < 0.0) continue;
+
+        std::transform(unit.begin(), unit.end(), unit.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (unit.rfind("d", 0) == 0) minutes += pending * 24.0 * 60.0;
+        else if (unit.rfind("h", 0) == 0) minutes += pending * 60.0;
+        else if (unit.rfind("m", 0) == 0) minutes += pending;
+        else continue;
+        pending = -1.0;
+        found = true;
     }
+    if (pending >= 0.0) { minutes += pending; found = true; }
+    return found ? static_cast<int>(minutes + 0.5) : -1;
+}
 
-    return result;
+static void parse_recipe_times(Recipe& r) {
+    r.total_minutes = parse_duration_minutes(r.time);
+    r.prep_minutes = parse_duration_minutes(r.prep_time);
+    r.cook_minutes = parse_duration_minutes(r.cook_time);
 }
 
 void read_recipes_from_csv(const std::string& filename) {
@@ -152,6 +212,7 @@ void read_recipes_from_csv(const std::string& filename) {
     std::vector<std::string> headers = parse_csv_line(header_line);
 
     int name_idx = -1, ingredients_idx = -1, directions_idx = -1, time_idx = -1;
+    int prep_idx = -1, cook_idx = -1, rating_idx = -1, cuisine_idx = -1, nutrition_idx = -1; // optional
 
     // Catch all desired rows, and assign the corresponding id values
     for (size_t i = 0; i < headers.size(); ++i) {
@@ -159,6 +220,11 @@ void read_recipes_from_csv(const std::string& filename) {
         else if (headers[i] == "ingredients") ingredients_idx = i;
         else if (headers[i] == "directions") directions_idx = i;
 	else if (headers[i] == "total_time") time_idx = i;
+        else if (headers[i] == "prep_time") prep_idx = i;
+        else if (headers[i] == "cook_time") cook_idx = i;
+        else if (headers[i] == "rating") rating_idx = i;
+        else if (headers[i] == "cuisine_path") cuisine_idx = i;
+        else if (headers[i] == "nutrition") nutrition_idx = i;
     }
 
     // Make sure all columns were found in data
@@ -167,33 +233,58 @@ void read_recipes_from_csv(const std::string& filename) {
         return;
     }
 
-    // Read through file, ensuring every row is complete
+    // Read through file, ensuring every row is complete. Records are split serially,
+    // then parsed in parallel into slots so the recipe order matches the file.
+    std::vector<std::string> records;
     while (file) {
         std::string record = read_csv_record(file);
         if (record.empty()) continue;
+        records.push_back(std::move(record));
+    }
 
-        std::vector<std::string> fields = parse_csv_line(record);
-        if (fields.size() <= std::max({name_idx, ingredients_idx, directions_idx, time_idx})) {
-            std::cerr << "Skipping malformed row with only " << fields.size() << " fields\n";
-            continue;
-        }
+    std::vector<Recipe> parsed(records.size());
+    std::vector<char> valid(records.size(), 0);
+    std::mutex log_mutex;
+
+    parallel_for(records.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            std::vector<std::string> fields = parse_csv_line(records[i]);
+            if (fields.size() <= std::max({name_idx, ingredients_idx, directions_idx, time_idx})) {
+                std::lock_guard<std::mutex> lock(log_mutex);
+                std::cerr << "Skipping malformed row with only " << fields.size() << " fields\n";
+                continue;
+            }
+
+            // Build recipe with data
+            Recipe& r = parsed[i];
+            r.name = fields[name_idx];
+            r.directions = fields[directions_idx];
+            r.time = fields[time_idx];
+            if (prep_idx >= 0 && prep_idx < static_cast<int>(fields.size())) r.prep_time = fields[prep_idx];
+            if (cook_idx >= 0 && cook_idx < static_cast<int>(fields.size())) r.cook_time = fields[cook_idx];
+            parse_recipe_times(r);
+            if (rating_idx >= 0 && rating_idx < static_cast<int>(fields.size()) && !fields[rating_idx].empty())
+                r.rating = static_cast<float>(std::atof(fields[rating_idx].c_str()));
+            if (cuisine_idx >= 0 && cuisine_idx < static_cast<int>(fields.size())) r.cuisine_path = fields[cuisine_idx];
+            if (nutrition_idx >= 0 && nutrition_idx < static_cast<int>(fields.size())) r.nutrition = fields[nutrition_idx];
+            r.nutrients = parse_nutrition(r.nutrition);
+
+            // Make sure all ingredients get parsed properly
+            try {
+                r.ingredients = parse_ingredients(fields[ingredients_idx]);
+            } catch (const std::regex_error& e) {
+                std::lock_guard<std::mutex> lock(log_mutex);
+                std::cerr << "Regex error while parsing ingredients: " << e.what() << "\n";
+                continue;
+            }
 
-	// Build recipe with data
-        Recipe r;
-        r.name = fields[name_idx];
-        r.directions = fields[directions_idx];
-	r.time = fields[time_idx];
-
-	// Make sure all ingredients get parsed properly
-        try {
-            r.ingredients = parse_ingredients(fields[ingredients_idx]);
-        } catch (const std::regex_error& e) {
-            std::cerr << "Regex error while parsing ingredients: " << e.what() << "\n";
-            continue;
+            valid[i] = 1;
         }
+    });
 
-	// Push recipe to global list
-        recipes.push_back(r); 
+    // Push recipes to global list
+    for (size_t i = 0; i < parsed.size(); ++i) {
+        if (valid[i]) recipes.push_back(std::move(parsed[i]));
     }
 
     // Hard code units to be used in drop-down selection
@@ -210,6 +301,70 @@ void read_recipes_from_csv(const std::string& filename) {
     file.close();
 }
 
+// Search keys of recipes[first_recipe] onwards, from their cleaned names, quantities and units
+static void compute_search_keys_from(size_t first_recipe) {
+    parallel_for(recipes.size() - first_recipe, [&](size_t begin, size_t end) {
+        for (size_t r = first_recipe + begin; r < first_recipe + end; ++r) {
+            recipes[r].name_key = search_key(recipes[r].name);
+            for (Ingredient& ing : recipes[r].ingredients) {
+                ing.name_key = search_key(ing.name);
+                ing.quantity_key = search_key(ing.quantity);
+                ing.unit_key = search_key(ing.unit);
+                ing.amount = ing.quantity_key.empty() ? -1.0 : parse_mixed_fraction(ing.quantity_key);
+            }
+        }
+    });
+}
+
+void load_recipes(const std::string& filename) {
+    std::unique_lock<std::shared_mutex> lock(dataset_lock);
+    recipes.clear();
+    availableUnits.clear();
+
+    auto start = std::chrono::steady_clock::now();
+    read_recipes_from_csv(filename);
+    auto parsed = std::chrono::steady_clock::now();
+    clean_all_ingredients_in_recipes();
+    compute_search_keys_from(0);
+    auto cleaned = std::chrono::steady_clock::now();
+    build_ingredient_dictionary();
+    build_entity_tags();
+    searchIndex.build();
+    pantryIndex.build();
+    auto linked = std::chrono::steady_clock::now();
+    // The vector graph is saved beside the recipe file and reused while the recipes are unchanged
+    std::string vector_path = std::filesystem::path(filename).replace_extension(".hnsw").string();
+    bool vectors_cached = searchIndex.vectors.load_or_build(vector_path);
+    ++generation;
+    auto vectorized = std::chrono::steady_clock::now();
+
+    auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+    std::cout << "Loaded " << recipes.size() << " recipes ("
+              << (parallel_enabled() ? std::to_string(shared_thread_pool().size() + 1) + " threads" : std::string("serial"))
+              << "): read " << ms(start, parsed) << " ms, clean " << ms(parsed, cleaned)
+              << " ms, link " << ms(cleaned, linked) << " ms, vectors " << ms(linked, vectorized)
+              << (vectors_cached ? " ms (read from " : " ms (built, saved to ") << vector_path << ")\n";
+
+    for (const auto& [label, stats] : {std::make_pair("parse", parse_cache.stats()),
+                                       std::make_pair("clean", clean_cache.stats())}) {
+        std::cout << "Ingredient " << label << " cache: " << stats.hits << " hits, " << stats.misses
+                  << " misses (" << stats.hit_rate() * 100.0 << "% hit rate), " << stats.entries << " entries\n";
+    }
+}
+
+void clear_ingredient_caches() {
+    parse_cache.clear();
+    clean_cache.clear();
+}
+
+MemoCacheStats ingredient_parse_cache_stats() {
+    return parse_cache.stats();
+}
+
+MemoCacheStats ingredient_clean_cache_stats() {
+    return clean_cache.stats();
+}
+
 std::string clean_and_format_ingredients(const std::vector<Ingredient>& ingredients) {
     std::unordered_map<std::string, std::string> unit_map = {
         {"T", "tbsp"}, {"Tbsp", "tbsp"}, {"TBS", "tbsp"}, {"Tablespoon", "tbsp"},
@@ -381,7 +536,8 @@ std::vector<std::string> split_numbered_steps(const std::string& text) {
 }
 
 
-void clean_all_ingredients_in_recipes() {
+// Cleans the ingredients of recipes[first_recipe] onwards
+static void clean_ingredients_from(size_t first_recipe) {
     std::unordered_map<std::string, std::string> unit_map = {
         {"T", "tbsp"}, {"Tbsp", "tbsp"}, {"TBS", "tbsp"}, {"Tablespoon", "tbsp"},
         {"tablespoons", "tbsp"}, {"tablespoon", "tbsp"}, {"t", "tsp"},
@@ -399,6 +555,20 @@ void clean_all_ingredients_in_recipes() {
         {"1/8", "⅛"}, {"3/8", "⅜"}, {"5/8", "⅝"}, {"7/8", "⅞"}
     };
 
+    // Compile every pattern once up front, in the same order the maps iterate.
+    // Matching against a const std::regex is safe from several threads at once.
+    const std::regex mixed_number_pattern(R"((\b\d+)\s+(\d/\d)\b)");
+
+    std::vector<std::pair<std::regex, std::string>> fraction_patterns;
+    for (const auto& [ascii_frac, unicode_frac] : ascii_to_unicode) {
+        fraction_patterns.emplace_back(std::regex(R"(\b)" + ascii_frac + R"(\b)"), unicode_frac);
+    }
+
+    std::vector<std::pair<std::regex, std::string>> unit_patterns;
+    for (const auto& [key, replacement] : unit_map) {
+        unit_patterns.emplace_back(std::regex("\\b" + key + "\\b", std::regex_constants::icase), replacement);
+    }
+
     auto trim = [](std::string& s) {
         s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](int ch) {
             return !std::isspace(ch);
@@ -409,7 +579,6 @@ void clean_all_ingredients_in_recipes() {
     };
 
     auto convert_to_unicode_fractions = [&](std::string& qty) {
-        std::regex mixed_number_pattern(R"((\b\d+)\s+(\d/\d)\b)");
         std::smatch match;
 
         // Convert mixed numbers (e.g., "1 1/2" → "1½")
@@ -425,26 +594,62 @@ void clean_all_ingredients_in_recipes() {
         }
 
         // Convert standalone fractions (e.g., "1/2" → "½")
-        for (const auto& [ascii_frac, unicode_frac] : ascii_to_unicode) {
-            std::regex standalone_frac(R"(\b)" + ascii_frac + R"(\b)");
-            qty = std::regex_replace(qty, standalone_frac, unicode_frac);
+        for (const auto& [pattern, unicode_frac] : fraction_patterns) {
+            qty = std::regex_replace(qty, pattern, unicode_frac);
         }
     };
 
-    for (Recipe& recipe : recipes) {
-        for (Ingredient& ing : recipe.ingredients) {
-            trim(ing.quantity);
-            trim(ing.unit);
-            trim(ing.name);
-
-            convert_to_unicode_fractions(ing.quantity);
-
-            for (const auto& [key, replacement] : unit_map) {
-                std::regex pattern("\\b" + key + "\\b", std::regex_constants::icase);
-                ing.unit = std::regex_replace(ing.unit, pattern, replacement);
+    // Every recipe is cleaned independently and in place, so the result does not depend on scheduling
+    parallel_for(recipes.size() - first_recipe, [&](size_t begin, size_t end) {
+        for (size_t r = first_recipe + begin; r < first_recipe + end; ++r) {
+            for (Ingredient& ing : recipes[r].ingredients) {
+                trim(ing.name);
+
+                // The cleaned quantity and unit depend only on the raw pair, which repeats heavily
+                std::string key = ing.quantity + '\x1f' + ing.unit;
+                auto cleaned = clean_cache.get_or_compute(key, [&](const std::string&) {
+                    std::string qty = ing.quantity;
+                    std::string unit = ing.unit;
+                    trim(qty);
+                    trim(unit);
+
+                    convert_to_unicode_fractions(qty);
+
+                    for (const auto& [pattern, replacement] : unit_patterns) {
+                        unit = std::regex_replace(unit, pattern, replacement);
+                    }
+                    return std::make_pair(qty, unit);
+                });
+                ing.quantity = std::move(cleaned.first);
+                ing.unit = std::move(cleaned.second);
             }
         }
-    }
+    });
+}
+
+void clean_all_ingredients_in_recipes() {
+    clean_ingredients_from(0);
+}
+
+void append_recipe(const Recipe& recipe) {
+    std::unique_lock<std::shared_mutex> lock(dataset_lock);
+    recipes.push_back(recipe);
+    parse_recipe_times(recipes.back());
+    recipes.back().nutrients = parse_nutrition(recipes.back().nutrition);
+    clean_ingredients_from(recipes.size() - 1);
+    compute_search_keys_from(recipes.size() - 1);
+    link_recipe_ingredients(recipes.back());
+    searchIndex.add_recipe(static_cast<uint32_t>(recipes.size() - 1));
+    pantryIndex.add_recipe(static_cast<uint32_t>(recipes.size() - 1));
+    ++generation;
+}
+
+uint64_t dataset_generation() {
+    return generation.load();
+}
+
+std::shared_mutex& dataset_mutex() {
+    return dataset_lock;
 }
 
 double parse_mixed_fraction(const std::string& input) {
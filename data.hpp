@@ -1,18 +1,47 @@
 #pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 
+#include "memoCache.hpp"
+#include "nutritionColumns.hpp"
+
+// Marks an ingredient line that did not resolve to any canonical ingredient (e.g. "melted")
+constexpr uint32_t kNoIngredientId = UINT32_MAX;
+
 struct Ingredient {
     std::string quantity;
     std::string name;
     std::string unit;
+    uint32_t canonical_id = kNoIngredientId; // index into ingredientDictionary, assigned at load
+    std::vector<uint32_t> tags;              // every dictionary entity mentioned in the line
+
+    // Case-folded, trimmed forms of the fields above (see search_key), which the filters compare
+    // against, and the parsed quantity (-1 when there is none); set at load
+    std::string name_key;
+    std::string quantity_key;
+    std::string unit_key;
+    double amount = -1.0;
 };
 
 struct Recipe {
     std::string name;
+    std::string name_key; // search_key(name), set at load
     std::vector<Ingredient> ingredients;
     std::string directions;
     std::string time;
+    std::vector<uint32_t> mentioned_ids; // sorted dictionary entities mentioned in the directions
+    std::string prep_time;
+    std::string cook_time;
+    int total_minutes = -1; // parsed from the time strings at load, -1 when missing
+    int prep_minutes = -1;
+    int cook_minutes = -1;
+    float rating = -1.0f;   // average user rating (0-5), -1 when the CSV has none
+    std::string cuisine_path; // "/Desserts/Fruit Desserts/Apple Dessert Recipes/", empty when unknown
+    std::string nutrition;    // "Total Fat 5g 7%, Saturated Fat 3g 15%, ..." as in the CSV
+    NutritionFacts nutrients = parse_nutrition(""); // parsed from nutrition at load, NaN when missing
 };
 
 // Declare shared data
@@ -27,10 +56,35 @@ std::string clean_recipe_directions(const std::string& input_text);
 std::vector<std::string> split_numbered_steps(const std::string& text);
 double parse_mixed_fraction(const std::string& str);
 
+// "1 hrs 15 mins" -> 75, "2 days 3 hrs" -> 3060; -1 when the text holds no duration.
+// A bare number counts as minutes.
+int parse_duration_minutes(const std::string& text);
+
+// Reads one CSV record, which may span several lines inside a quoted field
+std::string read_csv_record(std::istream& file);
+std::vector<std::string> parse_csv_line(const std::string& line);
+
 void read_recipes_from_csv(const std::string& filename);
 
+// Reads the CSV, cleans every ingredient and links them to canonical ingredient ids
 void load_recipes(const std::string& filename);
 
+// Adds a recipe created in the app to the in-memory list: cleans, links and indexes it
+// exactly as if it had been read back from the CSV
+void append_recipe(const Recipe& recipe);
+
+// Bumped every time the recipe list changes; anything derived from it can compare generations
+uint64_t dataset_generation();
+
+// Held exclusively by load_recipes and append_recipe; threads other than the UI thread must
+// hold it shared while they read recipes or the indexes
+std::shared_mutex& dataset_mutex();
+
+// Hit rates of the memo tables shared by parse_ingredients and clean_all_ingredients_in_recipes
+MemoCacheStats ingredient_parse_cache_stats();
+MemoCacheStats ingredient_clean_cache_stats();
+void clear_ingredient_caches();
+
 void AppendRecipeToCSV(const std::string& filename,
                        const std::string& name,
                        const std::string& totalTime,
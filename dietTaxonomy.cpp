@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <unordered_map>
+
+#include "dietTaxonomy.hpp"
+
+namespace {
+
+struct CategoryRule {
+    const char* phrase;    // one word, or several separated by single spaces
+    CategoryMask adds;
+    CategoryMask removes;  // cleared from the whole name once all rules ran
+};
+
+constexpr CategoryMask kAnimal = kCategoryMeat | kCategoryPoultry | kCategoryFish | kCategoryShellfish;
+
+// Multi-word rules claim their words, so the single-word rules below no longer see them
+const CategoryRule kPhraseRules[] = {
+    {"peanut butter", kCategoryPeanut, 0},  {"almond butter", kCategoryTreeNut, 0},
+    {"apple butter", 0, 0},                 {"cocoa butter", 0, 0},
+    {"butter lettuce", 0, 0},               {"butter bean", 0, 0},
+    {"butter flavored", 0, 0},              {"coconut milk", 0, 0},
+    {"coconut cream", 0, 0},                {"cream coconut", 0, 0},
+    {"almond milk", kCategoryTreeNut, 0},   {"soy milk", kCategorySoy, 0},
+    {"rice milk", 0, 0},                    {"oat milk", 0, 0},
+    {"cream tartar", 0, 0},                 {"cream of tartar", 0, 0},
+    {"goat cheese", kCategoryDairy, 0},     {"whipped topping", kCategoryDairy, 0},
+    {"duck sauce", 0, 0},                   {"fish sauce", kCategoryFish, 0},
+    {"oyster sauce", kCategoryShellfish, 0},{"imitation crabmeat", kCategoryFish, 0},
+    {"soy sauce", kCategorySoy | kCategoryGluten, 0},
+    {"rice flour", 0, 0},                   {"coconut flour", 0, 0},
+    {"corn flour", 0, 0},                   {"chickpea flour", 0, 0},
+    {"buckwheat flour", 0, 0},              {"tapioca flour", 0, 0},
+    {"almond flour", kCategoryTreeNut, 0},  {"pie shell", kCategoryGluten, 0},
+    {"baking mix", kCategoryGluten, 0},     {"hot dog", kCategoryMeat, 0},
+    // Yeast sold in cakes or for bread machines is not a cake or bread
+    {"cake yeast", 0, 0},                   {"cake compressed yeast", 0, 0},
+    {"cake fresh yeast", 0, 0},             {"cake compressed fresh yeast", 0, 0},
+    {"bread machine yeast", 0, 0},
+    // Ginger ale is a soft drink, not a malt beverage
+    {"ginger ale", 0, 0},
+};
+
+const CategoryRule kWordRules[] = {
+    // Meat
+    {"beef", kCategoryMeat, 0}, {"pork", kCategoryMeat, 0}, {"bacon", kCategoryMeat, 0},
+    {"ham", kCategoryMeat, 0}, {"sausage", kCategoryMeat, 0}, {"lamb", kCategoryMeat, 0},
+    {"veal", kCategoryMeat, 0}, {"prosciutto", kCategoryMeat, 0}, {"pancetta", kCategoryMeat, 0},
+    {"salami", kCategoryMeat, 0}, {"pepperoni", kCategoryMeat, 0}, {"chorizo", kCategoryMeat, 0},
+    {"sirloin", kCategoryMeat, 0}, {"brisket", kCategoryMeat, 0}, {"chuck", kCategoryMeat, 0},
+    {"meatball", kCategoryMeat, 0}, {"hamburger", kCategoryMeat, 0}, {"bologna", kCategoryMeat, 0},
+    {"jerky", kCategoryMeat, 0}, {"venison", kCategoryMeat, 0}, {"bison", kCategoryMeat, 0},
+    {"gelatin", kCategoryMeat, 0}, {"lard", kCategoryMeat, 0},
+    // Poultry
+    {"chicken", kCategoryPoultry, 0}, {"turkey", kCategoryPoultry, 0}, {"duck", kCategoryPoultry, 0},
+    {"hen", kCategoryPoultry, 0}, {"goose", kCategoryPoultry, 0}, {"quail", kCategoryPoultry, 0},
+    // Fish
+    {"fish", kCategoryFish, 0}, {"salmon", kCategoryFish, 0}, {"tuna", kCategoryFish, 0},
+    {"cod", kCategoryFish, 0}, {"tilapia", kCategoryFish, 0}, {"anchovy", kCategoryFish, 0},
+    {"anchovie", kCategoryFish, 0}, {"halibut", kCategoryFish, 0}, {"trout", kCategoryFish, 0},
+    {"sardine", kCategoryFish, 0}, {"mahi", kCategoryFish, 0}, {"catfish", kCategoryFish, 0},
+    {"haddock", kCategoryFish, 0}, {"snapper", kCategoryFish, 0}, {"flounder", kCategoryFish, 0},
+    {"roughy", kCategoryFish, 0}, {"swordfish", kCategoryFish, 0}, {"bass", kCategoryFish, 0},
+    {"mackerel", kCategoryFish, 0}, {"herring", kCategoryFish, 0}, {"worcestershire", kCategoryFish, 0},
+    // Shellfish
+    {"shrimp", kCategoryShellfish, 0}, {"prawn", kCategoryShellfish, 0}, {"crab", kCategoryShellfish, 0},
+    {"crabmeat", kCategoryShellfish, 0}, {"lobster", kCategoryShellfish, 0}, {"clam", kCategoryShellfish, 0},
+    {"mussel", kCategoryShellfish, 0}, {"oyster", kCategoryShellfish, 0}, {"scallop", kCategoryShellfish, 0},
+    {"crawfish", kCategoryShellfish, 0}, {"crayfish", kCategoryShellfish, 0}, {"squid", kCategoryShellfish, 0},
+    {"calamari", kCategoryShellfish, 0}, {"octopus", kCategoryShellfish, 0},
+    // Dairy
+    {"milk", kCategoryDairy, 0}, {"butter", kCategoryDairy, 0}, {"cheese", kCategoryDairy, 0},
+    {"cream", kCategoryDairy, 0}, {"yogurt", kCategoryDairy, 0}, {"buttermilk", kCategoryDairy, 0},
+    {"parmesan", kCategoryDairy, 0}, {"mozzarella", kCategoryDairy, 0}, {"cheddar", kCategoryDairy, 0},
+    {"ricotta", kCategoryDairy, 0}, {"ghee", kCategoryDairy, 0}, {"whey", kCategoryDairy, 0},
+    {"half-and-half", kCategoryDairy, 0}, {"feta", kCategoryDairy, 0}, {"gruyere", kCategoryDairy, 0},
+    {"brie", kCategoryDairy, 0}, {"mascarpone", kCategoryDairy, 0}, {"provolone", kCategoryDairy, 0},
+    {"romano", kCategoryDairy, 0}, {"burrata", kCategoryDairy, 0}, {"halloumi", kCategoryDairy, 0},
+    {"gorgonzola", kCategoryDairy, 0}, {"havarti", kCategoryDairy, 0}, {"paneer", kCategoryDairy, 0},
+    {"kefir", kCategoryDairy, 0}, {"butterscotch", kCategoryDairy, 0}, {"fraiche", kCategoryDairy, 0},
+    {"custard", kCategoryDairy | kCategoryEgg, 0}, {"eggnog", kCategoryDairy | kCategoryEgg, 0},
+    // Egg
+    {"egg", kCategoryEgg, 0}, {"mayonnaise", kCategoryEgg, 0}, {"mayo", kCategoryEgg, 0},
+    {"meringue", kCategoryEgg, 0},
+    // Gluten; oats count too, since only certified oats are free of it
+    {"flour", kCategoryGluten, 0}, {"bread", kCategoryGluten, 0}, {"pasta", kCategoryGluten, 0},
+    {"spaghetti", kCategoryGluten, 0}, {"noodle", kCategoryGluten, 0}, {"macaroni", kCategoryGluten, 0},
+    {"penne", kCategoryGluten, 0}, {"linguine", kCategoryGluten, 0}, {"fettuccine", kCategoryGluten, 0},
+    {"lasagna", kCategoryGluten, 0}, {"orzo", kCategoryGluten, 0}, {"wheat", kCategoryGluten, 0},
+    {"barley", kCategoryGluten, 0}, {"rye", kCategoryGluten, 0}, {"couscous", kCategoryGluten, 0},
+    {"cracker", kCategoryGluten, 0}, {"crust", kCategoryGluten, 0}, {"pastry", kCategoryGluten, 0},
+    {"panko", kCategoryGluten, 0}, {"semolina", kCategoryGluten, 0}, {"bulgur", kCategoryGluten, 0},
+    {"farro", kCategoryGluten, 0}, {"farina", kCategoryGluten, 0}, {"freekeh", kCategoryGluten, 0},
+    {"seitan", kCategoryGluten, 0}, {"biscuit", kCategoryGluten, 0}, {"dough", kCategoryGluten, 0},
+    {"beer", kCategoryGluten, 0}, {"ale", kCategoryGluten, 0}, {"malt", kCategoryGluten, 0},
+    {"cake", kCategoryGluten, 0}, {"cookie", kCategoryGluten, 0}, {"wafer", kCategoryGluten, 0},
+    {"graham", kCategoryGluten, 0}, {"pretzel", kCategoryGluten, 0}, {"baguette", kCategoryGluten, 0},
+    {"ciabatta", kCategoryGluten, 0}, {"muffin", kCategoryGluten, 0}, {"brownie", kCategoryGluten, 0},
+    {"croissant", kCategoryGluten, 0}, {"crouton", kCategoryGluten, 0}, {"bun", kCategoryGluten, 0},
+    {"pita", kCategoryGluten, 0}, {"bagel", kCategoryGluten, 0}, {"naan", kCategoryGluten, 0},
+    {"stuffing", kCategoryGluten, 0}, {"cornflake", kCategoryGluten, 0}, {"oat", kCategoryGluten, 0},
+    {"breadcrumb", kCategoryGluten, 0}, {"gnocchi", kCategoryGluten, 0}, {"bisquick", kCategoryGluten, 0},
+    // Nuts
+    {"almond", kCategoryTreeNut, 0}, {"almondmilk", kCategoryTreeNut, 0}, {"walnut", kCategoryTreeNut, 0},
+    {"pecan", kCategoryTreeNut, 0}, {"cashew", kCategoryTreeNut, 0}, {"pistachio", kCategoryTreeNut, 0},
+    {"hazelnut", kCategoryTreeNut, 0}, {"macadamia", kCategoryTreeNut, 0}, {"nut", kCategoryTreeNut, 0},
+    {"praline", kCategoryTreeNut, 0}, {"marzipan", kCategoryTreeNut, 0}, {"nutella", kCategoryTreeNut, 0},
+    {"peanut", kCategoryPeanut, 0},
+    // Soy, sesame, honey
+    {"soy", kCategorySoy, 0}, {"tofu", kCategorySoy, 0}, {"edamame", kCategorySoy, 0},
+    {"tempeh", kCategorySoy, 0}, {"miso", kCategorySoy, 0}, {"hoisin", kCategorySoy, 0},
+    {"sesame", kCategorySesame, 0}, {"tahini", kCategorySesame, 0},
+    {"honey", kCategoryHoney, 0},
+    // Qualifiers
+    {"gluten-free", 0, kCategoryGluten}, {"dairy-free", 0, kCategoryDairy}, {"eggless", 0, kCategoryEgg},
+    {"vegan", 0, kAnimal | kCategoryDairy | kCategoryEgg | kCategoryHoney},
+};
+
+const CategoryRule* find_word_rule(const std::string& word) {
+    static const std::unordered_map<std::string, const CategoryRule*> by_word = [] {
+        std::unordered_map<std::string, const CategoryRule*> map;
+        for (const CategoryRule& rule : kWordRules) map.emplace(rule.phrase, &rule);
+        return map;
+    }();
+    auto it = by_word.find(word);
+    return it == by_word.end() ? nullptr : it->second;
+}
+
+std::vector<std::string> split_words(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream in(text);
+    std::string word;
+    while (in >> word) {
+        // Keep inner hyphens ("half-and-half"), drop surrounding punctuation and trailing
+        // trademark signs ("bisquick®", UTF-8 encoded)
+        auto ends_with = [&](const char* suffix) {
+            size_t n = std::char_traits<char>::length(suffix);
+            return word.size() >= n && word.compare(word.size() - n, n, suffix) == 0;
+        };
+        while (!word.empty()) {
+            if (std::ispunct(static_cast<unsigned char>(word.back()))) word.pop_back();
+            else if (ends_with("\xC2\xAE")) word.resize(word.size() - 2);      // ®
+            else if (ends_with("\xE2\x84\xA2")) word.resize(word.size() - 3); // ™
+            else break;
+        }
+        size_t start = 0;
+        while (start < word.size() && std::ispunct(static_cast<unsigned char>(word[start]))) ++start;
+        if (start < word.size()) words.push_back(word.substr(start));
+    }
+    return words;
+}
+
+} // namespace
+
+const std::vector<CategoryInfo>& category_list() {
+    static const std::vector<CategoryInfo> categories = {
+        {"Dairy", kCategoryDairy},     {"Egg", kCategoryEgg},         {"Gluten", kCategoryGluten},
+        {"Tree nuts", kCategoryTreeNut}, {"Peanuts", kCategoryPeanut}, {"Soy", kCategorySoy},
+        {"Sesame", kCategorySesame},   {"Shellfish", kCategoryShellfish}, {"Fish", kCategoryFish},
+        {"Meat", kCategoryMeat},       {"Poultry", kCategoryPoultry}, {"Honey", kCategoryHoney},
+    };
+    return categories;
+}
+
+const std::vector<DietInfo>& diet_list() {
+    static const std::vector<DietInfo> diets = {
+        {"Any", 0},
+        {"Vegetarian", kAnimal},
+        {"Pescatarian", kCategoryMeat | kCategoryPoultry},
+        {"Vegan", kAnimal | kCategoryDairy | kCategoryEgg | kCategoryHoney},
+        {"Gluten-free", kCategoryGluten},
+        {"Dairy-free", kCategoryDairy},
+    };
+    return diets;
+}
+
+CategoryMask categorize_ingredient_name(const std::string& lowered_name) {
+    std::vector<std::string> words = split_words(lowered_name);
+    std::vector<char> claimed(words.size(), 0);
+    CategoryMask adds = 0, removes = 0;
+
+    static const std::vector<std::vector<std::string>> phrases = [] {
+        std::vector<std::vector<std::string>> split;
+        for (const CategoryRule& rule : kPhraseRules) split.push_back(split_words(rule.phrase));
+        return split;
+    }();
+    for (size_t p = 0; p < phrases.size(); ++p) {
+        const CategoryRule& rule = kPhraseRules[p];
+        const std::vector<std::string>& phrase = phrases[p];
+        for (size_t start = 0; start + phrase.size() <= words.size(); ++start) {
+            if (!std::equal(phrase.begin(), phrase.end(), words.begin() + start)) continue;
+            adds |= rule.adds;
+            removes |= rule.removes;
+            std::fill(claimed.begin() + start, claimed.begin() + start + phrase.size(), 1);
+        }
+    }
+
+    for (size_t w = 0; w < words.size(); ++w) {
+        if (claimed[w]) continue;
+        const CategoryRule* rule = find_word_rule(words[w]);
+        // Canonical names are singular already; raw names may still be plural
+        if (!rule && words[w].size() > 3 && words[w].back() == 's')
+            rule = find_word_rule(words[w].substr(0, words[w].size() - 1));
+        if (!rule && words[w].size() > 4 && words[w].compare(words[w].size() - 2, 2, "es") == 0)
+            rule = find_word_rule(words[w].substr(0, words[w].size() - 2));
+        if (rule) {
+            adds |= rule->adds;
+            removes |= rule->removes;
+        }
+    }
+    return adds & ~removes;
+}
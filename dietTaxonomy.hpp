@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Ingredient categories for the exclusion and diet filters, one bit each
+using CategoryMask = uint32_t;
+
+constexpr CategoryMask kCategoryMeat      = 1u << 0;  // red meat, pork, gelatin, lard
+constexpr CategoryMask kCategoryPoultry   = 1u << 1;
+constexpr CategoryMask kCategoryFish      = 1u << 2;
+constexpr CategoryMask kCategoryShellfish = 1u << 3;
+constexpr CategoryMask kCategoryDairy     = 1u << 4;
+constexpr CategoryMask kCategoryEgg       = 1u << 5;
+constexpr CategoryMask kCategoryGluten    = 1u << 6;
+constexpr CategoryMask kCategoryTreeNut   = 1u << 7;
+constexpr CategoryMask kCategoryPeanut    = 1u << 8;
+constexpr CategoryMask kCategorySoy       = 1u << 9;
+constexpr CategoryMask kCategorySesame    = 1u << 10;
+constexpr CategoryMask kCategoryHoney     = 1u << 11;
+
+struct CategoryInfo {
+    const char* label;
+    CategoryMask mask;
+};
+
+// A diet is the set of categories it rules out
+struct DietInfo {
+    const char* label;
+    CategoryMask excluded;
+};
+
+// In display order; the first diet ("Any") excludes nothing
+const std::vector<CategoryInfo>& category_list();
+const std::vector<DietInfo>& diet_list();
+
+// Categories of one lowercased ingredient name. Phrases are matched before single words, so
+// "peanut butter" is a peanut and not dairy, "coconut milk" is neither, and "eggplant" is no egg.
+// Qualifiers such as "gluten-free" or "vegan" clear the categories they rule out.
+CategoryMask categorize_ingredient_name(const std::string& lowered_name);
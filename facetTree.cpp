@@ -0,0 +1,84 @@
+#include <algorithm>
+
+#include "facetTree.hpp"
+#include "data.hpp"
+
+void RecipeBitset::set(uint32_t recipe_id) {
+    if (words.size() <= recipe_id / 64) words.resize(recipe_id / 64 + 1, 0);
+    words[recipe_id / 64] |= uint64_t(1) << (recipe_id % 64);
+}
+
+size_t RecipeBitset::count_and(const RecipeBitset& other) const {
+    const size_t n = std::min(words.size(), other.words.size());
+    size_t count = 0;
+    for (size_t w = 0; w < n; ++w) count += __builtin_popcountll(words[w] & other.words[w]);
+    return count;
+}
+
+void FacetTree::clear() {
+    nodes.clear();
+}
+
+void FacetTree::build() {
+    clear();
+    for (uint32_t r = 0; r < recipes.size(); ++r) add_recipe(r);
+}
+
+uint32_t FacetTree::child(uint32_t parent, const std::string& name) {
+    std::vector<uint32_t>& siblings = nodes[parent].children;
+    auto it = std::lower_bound(siblings.begin(), siblings.end(), name,
+                               [&](uint32_t id, const std::string& n) { return nodes[id].name < n; });
+    if (it != siblings.end() && nodes[*it].name == name) return *it;
+
+    const uint32_t id = static_cast<uint32_t>(nodes.size());
+    siblings.insert(it, id); // before the push_back below, which may move the vector holding siblings
+    Node node;
+    node.name = name;
+    node.parent = parent;
+    node.depth = nodes[parent].depth + 1;
+    nodes.push_back(std::move(node));
+    return id;
+}
+
+void FacetTree::add_recipe(uint32_t recipe_id) {
+    if (nodes.empty()) nodes.emplace_back();
+
+    uint32_t node = kRoot;
+    nodes[node].recipes.set(recipe_id);
+    ++nodes[node].recipe_count;
+
+    const std::string& path = recipes[recipe_id].cuisine_path;
+    size_t start = 0;
+    while (start < path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos) end = path.size();
+        if (end > start) {
+            node = child(node, path.substr(start, end - start));
+            nodes[node].recipes.set(recipe_id);
+            ++nodes[node].recipe_count;
+        }
+        start = end + 1;
+    }
+}
+
+bool FacetTree::contains(uint32_t node_id, uint32_t recipe_id) const {
+    return node_id < nodes.size() && nodes[node_id].recipes.test(recipe_id);
+}
+
+std::string FacetTree::path(uint32_t node_id) const {
+    std::string out = "/";
+    std::vector<uint32_t> chain;
+    for (uint32_t n = node_id; n != kRoot && n < nodes.size(); n = nodes[n].parent) chain.push_back(n);
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) out += nodes[*it].name + "/";
+    return out;
+}
+
+std::vector<uint32_t> FacetTree::counts(const std::vector<uint32_t>& result_ids) const {
+    RecipeBitset results;
+    if (!result_ids.empty()) results.words.assign(*std::max_element(result_ids.begin(), result_ids.end()) / 64 + 1, 0);
+    for (uint32_t r : result_ids) results.set(r);
+
+    std::vector<uint32_t> out(nodes.size());
+    for (size_t n = 0; n < nodes.size(); ++n) out[n] = static_cast<uint32_t>(nodes[n].recipes.count_and(results));
+    return out;
+}
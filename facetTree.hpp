@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One bit per recipe id
+struct RecipeBitset {
+    std::vector<uint64_t> words;
+
+    void set(uint32_t recipe_id);
+    bool test(uint32_t recipe_id) const {
+        return recipe_id / 64 < words.size() && (words[recipe_id / 64] >> (recipe_id % 64)) & 1;
+    }
+    // popcount(this AND other)
+    size_t count_and(const RecipeBitset& other) const;
+};
+
+// Category hierarchy parsed from the recipes' cuisine_path ("/Desserts/Pies/Fruit Pies/").
+// Node 0 is the root holding every recipe; a recipe is in its own node and all of its ancestors,
+// so the number of results under any node is one AND-and-popcount pass over its bitset.
+class FacetTree {
+public:
+    static constexpr uint32_t kRoot = 0;
+
+    struct Node {
+        std::string name;
+        uint32_t parent = kRoot;
+        uint32_t depth = 0;
+        std::vector<uint32_t> children;  // sorted by name
+        RecipeBitset recipes;
+        uint32_t recipe_count = 0;
+    };
+
+    void build();
+    void add_recipe(uint32_t recipe_id);
+    void clear();
+
+    const Node& node(uint32_t id) const { return nodes[id]; }
+    size_t size() const { return nodes.size(); }
+    bool contains(uint32_t node_id, uint32_t recipe_id) const;
+
+    // "/Desserts/Pies/" style path of a node
+    std::string path(uint32_t node_id) const;
+
+    // Results under every node: counts[node] = |node AND results|; results may be in any order
+    std::vector<uint32_t> counts(const std::vector<uint32_t>& results) const;
+
+private:
+    uint32_t child(uint32_t parent, const std::string& name);
+
+    std::vector<Node> nodes;
+};
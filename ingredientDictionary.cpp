@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
+#include "ingredientDictionary.hpp"
+#include "threadPool.hpp"
+
+IngredientDictionary ingredientDictionary;
+
+static AhoCorasick ingredientMatcher;
+
+uint32_t IngredientDictionary::find(const std::string& canonical) const {
+    auto it = ids.find(canonical);
+    return it == ids.end() ? kNoIngredientId : it->second;
+}
+
+uint32_t IngredientDictionary::intern(const std::string& canonical) {
+    if (canonical.empty()) return kNoIngredientId;
+
+    auto it = ids.find(canonical);
+    if (it != ids.end()) return it->second;
+
+    uint32_t id = static_cast<uint32_t>(names.size());
+    names.push_back(canonical);
+    frequency.push_back(0);
+    ids.emplace(canonical, id);
+    return id;
+}
+
+void IngredientDictionary::clear() {
+    names.clear();
+    frequency.clear();
+    ids.clear();
+}
+
+// Words that describe a unit of measure or a container rather than the ingredient itself
+static const std::unordered_set<std::string> measure_words = {
+    "cup", "cups", "tsp", "tbsp", "teaspoon", "teaspoons", "tablespoon", "tablespoons",
+    "oz", "ounce", "ounces", "fluid", "fl", "pound", "pounds", "lb", "lbs", "g", "gram", "grams",
+    "kg", "ml", "l", "liter", "liters", "quart", "quarts", "pint", "pints", "gallon", "gallons",
+    "pinch", "pinches", "dash", "dashes", "inch", "inches", "t", "c"
+};
+
+// Containers and portions; "clove" is kept when nothing else is left ("ground cloves")
+static const std::unordered_set<std::string> portion_words = {
+    "clove", "cloves", "can", "cans", "package", "packages", "jar", "jars", "bottle", "bottles",
+    "bunch", "bunches", "head", "heads", "stalk", "stalks", "sprig", "sprigs", "slice", "slices",
+    "envelope", "envelopes", "container", "containers", "box", "boxes", "bag", "bags", "loaf",
+    "stick", "sticks", "piece", "pieces", "cube", "cubes", "wedge", "wedges", "strip", "strips"
+};
+
+// Preparation and size descriptors plus filler words
+static const std::unordered_set<std::string> descriptor_words = {
+    "chopped", "finely", "coarsely", "roughly", "thinly", "minced", "diced", "sliced", "grated",
+    "shredded", "melted", "softened", "beaten", "lightly", "well", "divided", "peeled", "cored",
+    "seeded", "pitted", "halved", "quartered", "crushed", "mashed", "drained", "rinsed", "thawed",
+    "frozen", "fresh", "freshly", "large", "medium", "small", "extra", "ripe", "juiced", "zested",
+    "packed", "firmly", "sifted", "cubed", "cut", "trimmed", "cooked", "uncooked", "boneless",
+    "skinless", "room", "temperature", "warm", "cold", "toasted", "ground", "optional", "taste",
+    "needed", "more", "plus", "about", "into", "to", "and", "of", "the", "a", "an", "with", "as",
+    "if", "at", "in", "each", "such", "very", "prepared", "torn", "removed", "separated", "undrained",
+    "or", "up", "lengthwise", "crosswise", "shelled", "deveined", "stemmed", "hulled", "dice",
+    "chunk", "chunks", "bite-size", "bite-sized", "half", "halves"
+};
+
+// Words that end in "s" without being plural
+static const std::unordered_set<std::string> singular_exceptions = {
+    "molasses", "swiss", "hummus", "asparagus", "couscous", "citrus", "grits", "brussels",
+    "watercress", "cress", "bass", "lemongrass", "schnapps", "chess", "hibiscus", "octopus"
+};
+
+static const std::unordered_map<std::string, std::string> irregular_plurals = {
+    {"leaves", "leaf"}, {"halves", "half"}, {"loaves", "loaf"}, {"knives", "knife"},
+    {"potatoes", "potato"}, {"tomatoes", "tomato"}, {"mangoes", "mango"}, {"cookies", "cookie"}
+};
+
+static std::string singularize(const std::string& word) {
+    if (word.size() <= 3 || singular_exceptions.count(word)) return word;
+
+    auto irregular = irregular_plurals.find(word);
+    if (irregular != irregular_plurals.end()) return irregular->second;
+
+    auto ends_with = [&](const char* suffix) {
+        size_t n = std::char_traits<char>::length(suffix);
+        return word.size() > n && word.compare(word.size() - n, n, suffix) == 0;
+    };
+
+    if (ends_with("ies")) return word.substr(0, word.size() - 3) + "y";
+    if (ends_with("oes") || ends_with("ches") || ends_with("shes") || ends_with("xes") || ends_with("sses"))
+        return word.substr(0, word.size() - 2);
+    if (ends_with("ss") || ends_with("us") || ends_with("is")) return word;
+    if (word.back() == 's') return word.substr(0, word.size() - 1);
+    return word;
+}
+
+std::string canonicalize_ingredient_text(const std::string& input) {
+    std::string text;
+    text.reserve(input.size());
+
+    // Lowercase and drop parenthetical package sizes, e.g. "(8 ounce)". An unclosed "(" drops the rest.
+    int depth = 0;
+    for (unsigned char c : input) {
+        if (c == '(') { ++depth; continue; }
+        if (c == ')') { if (depth > 0) --depth; continue; }
+        if (depth == 0) text += static_cast<char>(std::tolower(c));
+    }
+
+    // Cut trailing preparation notes and alternatives ("apples - peeled", "butter or margarine")
+    for (const char* separator : {" - ", ";", " or ", " for ", " to taste"}) {
+        size_t pos = text.find(separator);
+        if (pos != std::string::npos) text.erase(pos);
+    }
+
+    // Split into words; hyphens inside a word are kept ("all-purpose")
+    std::vector<std::string> words;
+    std::string word;
+    auto flush = [&]() {
+        while (!word.empty() && word.back() == '-') word.pop_back();
+        while (!word.empty() && word.front() == '-') word.erase(word.begin());
+        if (!word.empty()) words.push_back(word);
+        word.clear();
+    };
+    for (unsigned char c : text) {
+        if (std::isalpha(c) || c == '-' || c >= 0x80) {
+            word += static_cast<char>(c);
+        } else {
+            flush();
+        }
+    }
+    flush();
+
+    std::vector<std::string> kept;
+    std::vector<std::string> portions;
+    for (const std::string& w : words) {
+        // Non-ASCII leftovers are unicode fractions such as "½"
+        if (static_cast<unsigned char>(w[0]) >= 0x80) continue;
+        if (measure_words.count(w) || descriptor_words.count(w)) continue;
+        if (portion_words.count(w)) {
+            portions.push_back(w);
+            continue;
+        }
+        kept.push_back(singularize(w));
+    }
+
+    if (kept.empty() && !portions.empty() && portions.back().compare(0, 5, "clove") == 0) {
+        kept.push_back(singularize(portions.back()));
+    }
+
+    std::string canonical;
+    for (const std::string& w : kept) {
+        if (!canonical.empty()) canonical += ' ';
+        canonical += w;
+    }
+    return canonical;
+}
+
+std::string canonicalize_ingredient(const Ingredient& ing) {
+    // parse_ingredients puts the first word after the quantity in the unit slot,
+    // so a unit that is not a measure is really the start of the name ("2 apples")
+    std::string unit = ing.unit;
+    std::transform(unit.begin(), unit.end(), unit.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    if (unit.empty() || measure_words.count(unit))
+        return canonicalize_ingredient_text(ing.name);
+    return canonicalize_ingredient_text(ing.unit + " " + ing.name);
+}
+
+void build_ingredient_dictionary() {
+    // Canonical names are computed in parallel; ids are then assigned serially so they are deterministic
+    std::vector<std::vector<std::string>> canonical(recipes.size());
+    parallel_for(recipes.size(), [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            canonical[r].reserve(recipes[r].ingredients.size());
+            for (const Ingredient& ing : recipes[r].ingredients) {
+                canonical[r].push_back(canonicalize_ingredient(ing));
+            }
+        }
+    });
+
+    std::unordered_map<std::string, uint32_t> counts;
+    for (const auto& names : canonical) {
+        for (const std::string& name : names) {
+            if (!name.empty()) ++counts[name];
+        }
+    }
+
+    std::vector<std::pair<std::string, uint32_t>> ordered(counts.begin(), counts.end());
+    std::sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+
+    ingredientDictionary.clear();
+    ingredientDictionary.names.reserve(ordered.size());
+    ingredientDictionary.frequency.reserve(ordered.size());
+    for (const auto& [name, count] : ordered) {
+        uint32_t id = ingredientDictionary.intern(name);
+        ingredientDictionary.frequency[id] = count;
+    }
+
+    parallel_for(recipes.size(), [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            for (size_t i = 0; i < recipes[r].ingredients.size(); ++i) {
+                recipes[r].ingredients[i].canonical_id = ingredientDictionary.find(canonical[r][i]);
+            }
+        }
+    });
+}
+
+static std::string pluralize(const std::string& name) {
+    auto ends_with = [&](const char* suffix) {
+        size_t n = std::char_traits<char>::length(suffix);
+        return name.size() > n && name.compare(name.size() - n, n, suffix) == 0;
+    };
+
+    if (ends_with("y") && name.size() >= 2 && std::string("aeiou").find(name[name.size() - 2]) == std::string::npos)
+        return name.substr(0, name.size() - 1) + "ies";
+    if (ends_with("s") || ends_with("x") || ends_with("ch") || ends_with("sh") || ends_with("o"))
+        return name + "es";
+    return name + "s";
+}
+
+static void tag_recipe_entities(Recipe& recipe) {
+    auto distinct_ids = [](const std::vector<EntityMatch>& matches) {
+        std::vector<uint32_t> ids;
+        for (const EntityMatch& m : matches) ids.push_back(m.id);
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        return ids;
+    };
+
+    for (Ingredient& ing : recipe.ingredients) {
+        ing.tags = distinct_ids(ingredientMatcher.find_all(ing.unit + " " + ing.name));
+    }
+    recipe.mentioned_ids = distinct_ids(ingredientMatcher.find_all(recipe.directions));
+}
+
+static void rebuild_matcher() {
+    std::vector<std::pair<std::string, uint32_t>> patterns;
+    patterns.reserve(ingredientDictionary.size() * 2);
+    for (uint32_t id = 0; id < ingredientDictionary.size(); ++id) {
+        patterns.emplace_back(ingredientDictionary.names[id], id);
+    }
+    // Plurals go after every canonical name so an exact canonical name always keeps its own id
+    for (uint32_t id = 0; id < ingredientDictionary.size(); ++id) {
+        patterns.emplace_back(pluralize(ingredientDictionary.names[id]), id);
+    }
+    ingredientMatcher.build(patterns);
+}
+
+void build_entity_tags() {
+    rebuild_matcher();
+
+    parallel_for(recipes.size(), [](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            tag_recipe_entities(recipes[r]);
+        }
+    });
+}
+
+std::vector<EntityMatch> find_ingredient_mentions(const std::string& text) {
+    return keep_longest_matches(ingredientMatcher.find_all(text));
+}
+
+void link_recipe_ingredients(Recipe& recipe) {
+    bool added = false;
+    for (Ingredient& ing : recipe.ingredients) {
+        size_t before = ingredientDictionary.size();
+        ing.canonical_id = ingredientDictionary.intern(canonicalize_ingredient(ing));
+        if (ing.canonical_id != kNoIngredientId) ++ingredientDictionary.frequency[ing.canonical_id];
+        added |= ingredientDictionary.size() != before;
+    }
+
+    // New entities need a rebuilt matcher before they can be tagged; the rest of the corpus keeps its tags
+    if (added) rebuild_matcher();
+    tag_recipe_entities(recipe);
+}
+
+std::vector<uint32_t> match_ingredient_ids(const std::string& query) {
+    std::vector<uint32_t> result;
+    std::string canonical = canonicalize_ingredient_text(query);
+    if (canonical.empty()) return result;
+
+    for (uint32_t id = 0; id < ingredientDictionary.size(); ++id) {
+        if (ingredientDictionary.names[id].find(canonical) != std::string::npos) {
+            result.push_back(id);
+        }
+    }
+    return result;
+}
+
+uint32_t find_ingredient_id(const std::string& text) {
+    return ingredientDictionary.find(canonicalize_ingredient_text(text));
+}
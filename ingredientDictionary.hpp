@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ahoCorasick.hpp"
+#include "data.hpp"
+
+// Corpus-wide dictionary of canonical ingredient names ("egg", "brown sugar", ...).
+// Ids are handed out by descending frequency, so the most common ingredients get the smallest ids.
+struct IngredientDictionary {
+    std::vector<std::string> names;       // canonical name by id
+    std::vector<uint32_t> frequency;      // number of ingredient lines linked to each id
+    std::unordered_map<std::string, uint32_t> ids;
+
+    size_t size() const { return names.size(); }
+    uint32_t find(const std::string& canonical) const;
+
+    // Returns the id of a canonical name, adding it to the end of the dictionary if it is new
+    uint32_t intern(const std::string& canonical);
+    void clear();
+};
+
+extern IngredientDictionary ingredientDictionary;
+
+// Strips quantities, units, descriptors ("chopped", "melted"), parenthetical package sizes
+// and plurals, e.g. "(8 ounce) package cream cheese, softened" -> "cream cheese"
+std::string canonicalize_ingredient_text(const std::string& text);
+std::string canonicalize_ingredient(const Ingredient& ing);
+
+// Canonicalizes every ingredient of every recipe and rebuilds the dictionary from scratch
+void build_ingredient_dictionary();
+
+// Links the ingredients of one recipe added after the dictionary was built
+void link_recipe_ingredients(Recipe& recipe);
+
+// Tags every ingredient line and directions text with the dictionary entities it mentions.
+// The matcher is an Aho-Corasick automaton over the canonical names and their plurals.
+void build_entity_tags();
+
+// Entity mentions in arbitrary text (e.g. one direction step), longest match first at each position
+std::vector<EntityMatch> find_ingredient_mentions(const std::string& text);
+
+// Ids of every dictionary entry whose canonical name contains the canonical form of query
+std::vector<uint32_t> match_ingredient_ids(const std::string& query);
+
+// Id of the dictionary entry that is exactly the canonical form of text ("Eggs" -> egg),
+// or kNoIngredientId. Unlike match_ingredient_ids, "egg" does not resolve to "eggplant".
+uint32_t find_ingredient_id(const std::string& text);
@@ -255,11 +255,11 @@ int main(int argc, char** argv)
     std::filesystem::path executable_dir = get_executable_directory(argv[0]);
     std::filesystem::path csv_path = executable_dir / "recipes.csv";
 	
-    read_recipes_from_csv(csv_path);
+    load_recipes(csv_path);
 
-    clean_all_ingredients_in_recipes();
     // Main loop
     bool done = false;
+    int idle_frames = 0;
 
 #ifdef __EMSCRIPTEN__
     // For an Emscripten build we are disabling file-system access, so let's not attempt to do a fopen() of the imgui.ini file.
@@ -270,16 +270,24 @@ int main(int argc, char** argv)
     while (!done)
 #endif
     {
+	// While idle, block until input arrives instead of redrawing every vsync.
+	// A few frames are still drawn after each event so ImGui can settle hover and focus state.
+	if (idle_frames >= 3)
+	    SDL_WaitEventTimeout(nullptr, 500);
+
 	// Listen for events
         SDL_Event event;
+        bool had_event = false;
         while (SDL_PollEvent(&event))
         {
+            had_event = true;
             ImGui_ImplSDL3_ProcessEvent(&event);
             if (event.type == SDL_EVENT_QUIT)
                 done = true;
             if (event.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED && event.window.windowID == SDL_GetWindowID(window))
                 done = true;
         }
+        idle_frames = had_event ? 0 : idle_frames + 1;
 
         // [If using SDL_MAIN_USE_CALLBACKS: all code below would likely be your SDL_AppIterate() function]
         if (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED)
@@ -308,14 +316,6 @@ int main(int argc, char** argv)
 		ShowExportPage(appState);       
 		break;
 	}
-	
-	// If returning to main menu, reload recipes to ensure list is up-to-date
-	if((appState.previousPage != Page::MainMenu) && (appState.currentPage == Page::MainMenu)) {
-		recipes.clear();
-		read_recipes_from_csv(csv_path);
-		clean_all_ingredients_in_recipes();
-
-	}
 
 	// Track pages across frames to look for change
 	appState.previousPage = appState.currentPage;
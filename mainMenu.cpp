@@ -1,5 +1,85 @@
 #include "mainMenu.h"
 
+// Shows a recipe in the display window
+static void SelectRecipe(AppState& appState, int recipe_idx) {
+    if (appState.current_recipe_idx == recipe_idx) return;
+    appState.current_recipe_idx = recipe_idx;
+    appState.current_recipe = recipes[recipe_idx].name;
+    appState.current_ingredients = recipes[recipe_idx].ingredients;
+    appState.current_directions = recipes[recipe_idx].directions;
+}
+
+// Suggestions offered under an input box while it is being edited
+struct CompletionDropdown {
+    bool open = false;
+    std::string query;      // text the suggestions belong to
+    uint64_t generation = 0;
+    std::vector<Completion> suggestions;
+};
+
+static constexpr size_t kCompletionCount = 8;
+
+// Call right after the InputText it belongs to; picking a suggestion replaces the buffer's text.
+// Completions are looked up again only when the text or the dataset changes.
+static void RenderCompletions(const char* window_id, char* buffer, size_t buffer_size,
+                              const CompletionTrie& trie, CompletionDropdown& dropdown) {
+    const bool input_active = ImGui::IsItemActive();
+    if (ImGui::IsItemActivated() || ImGui::IsItemEdited()) dropdown.open = true;
+    if (input_active && ImGui::IsKeyPressed(ImGuiKey_Escape)) dropdown.open = false;
+    if (!dropdown.open || buffer[0] == '\0') return;
+
+    if (dropdown.query != buffer || dropdown.generation != dataset_generation()) {
+        dropdown.query = buffer;
+        dropdown.generation = dataset_generation();
+        dropdown.suggestions = trie.complete(fold_case(dropdown.query), kCompletionCount);
+    }
+    if (dropdown.suggestions.empty()) {
+        dropdown.open = input_active;
+        return;
+    }
+
+    // A separate window so the list can overlap the widgets below the input
+    const float width = ImGui::GetItemRectSize().x;
+    ImGui::SetNextWindowPos(ImVec2(ImGui::GetItemRectMin().x, ImGui::GetItemRectMax().y));
+    ImGui::SetNextWindowSizeConstraints(ImVec2(width, 0.0f), ImVec2(width, FLT_MAX));
+    ImGui::Begin(window_id, nullptr,
+                 ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize |
+                 ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoDocking |
+                 ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_AlwaysAutoResize);
+    ImGui::BringWindowToDisplayFront(ImGui::GetCurrentWindow());
+    for (size_t i = 0; i < dropdown.suggestions.size(); ++i) {
+        ImGui::PushID(static_cast<int>(i));
+        if (ImGui::Selectable(dropdown.suggestions[i].text->c_str())) {
+            std::snprintf(buffer, buffer_size, "%s", dropdown.suggestions[i].text->c_str());
+            dropdown.open = false;
+        }
+        ImGui::PopID();
+    }
+    // Clicking a suggestion deactivates the input first, so stay open while the list is hovered
+    const bool hovered = ImGui::IsWindowHovered();
+    ImGui::End();
+    if (!input_active && !hovered) dropdown.open = false;
+}
+
+// One cuisine category with its match count and, when expanded, its subcategories.
+// Categories without matches are hidden; clicking selects the category or clears the selection.
+static void RenderFacetNode(const FacetTree& tree, uint32_t id, const std::vector<uint32_t>& counts, uint32_t& selected) {
+    const FacetTree::Node& node = tree.node(id);
+    const uint32_t count = id < counts.size() ? counts[id] : 0;
+    if (count == 0 && id != selected) return;
+
+    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth;
+    if (node.children.empty()) flags |= ImGuiTreeNodeFlags_Leaf;
+    if (id == selected) flags |= ImGuiTreeNodeFlags_Selected;
+    bool open = ImGui::TreeNodeEx(reinterpret_cast<void*>(static_cast<intptr_t>(id)), flags, "%s (%u)", node.name.c_str(), count);
+    if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen())
+        selected = selected == id ? FacetTree::kRoot : id;
+    if (open) {
+        for (uint32_t child : node.children) RenderFacetNode(tree, child, counts, selected);
+        ImGui::TreePop();
+    }
+}
+
 void RenderSearchWindow(AppState& appState) {
     ImGui::PushFont(appState.font_normal);
     ImGui::Begin("Search Window");
@@ -7,20 +87,36 @@ void RenderSearchWindow(AppState& appState) {
     // Dish name input
     static char dishName[40] = "";
     ImGui::InputText("Dish Name", dishName, IM_ARRAYSIZE(dishName));
+    static CompletionDropdown dishCompletions;
+    RenderCompletions("##dish_completions", dishName, IM_ARRAYSIZE(dishName), searchIndex.name_completions, dishCompletions);
 
-    std::string currentText(dishName);
-    std::transform(currentText.begin(), currentText.end(), currentText.begin(),
-        [](unsigned char c){ return std::tolower(c); });
+    static bool fuzzy_matching = false;
+    ImGui::Checkbox("Fuzzy matching", &fuzzy_matching);
+    ImGui::SetItemTooltip("Also match misspelled dish and ingredient names");
+    ImGui::SameLine();
+    static bool rank_by_relevance = false;
+    ImGui::Checkbox("Rank by relevance", &rank_by_relevance);
+    ImGui::SetItemTooltip("Order results by how well the name, ingredients and directions match the search text");
+
+    static char similarText[128] = "";
+    ImGui::InputText("Similar To", similarText, IM_ARRAYSIZE(similarText));
+    ImGui::SetItemTooltip("Free text such as \"creamy garlic pasta with mushrooms\"; lists the recipes whose\n"
+                          "name, ingredients and directions are closest to it, most similar first");
 
     static char ingredientName[32] = "";
     static char ingredientQuantity[32] = "";
     static char recipeTime[32] = "";
+    static char directionsText[64] = "";
+    static char advancedQuery[128] = "";
     static int selected_unit_idx = 0;
     static bool include_less_equal = false; // new toggle
 
     if (ImGui::TreeNode("Additional Filters")) {
         if (ImGui::BeginChild("FilterChild", ImVec2(-FLT_MIN, 0), ImGuiChildFlags_Borders | ImGuiChildFlags_AutoResizeY)) {
             ImGui::InputText("Ingredient Name", ingredientName, IM_ARRAYSIZE(ingredientName));
+            static CompletionDropdown ingredientCompletions;
+            RenderCompletions("##ingredient_completions", ingredientName, IM_ARRAYSIZE(ingredientName),
+                              searchIndex.ingredient_completions, ingredientCompletions);
             ImGui::InputText("Ingredient Quantity", ingredientQuantity, IM_ARRAYSIZE(ingredientQuantity));
 
             if (!availableUnits.empty()) {
@@ -38,148 +134,170 @@ void RenderSearchWindow(AppState& appState) {
             }
 
             ImGui::InputText("Recipe Time", recipeTime, IM_ARRAYSIZE(recipeTime));
+            ImGui::SetItemTooltip("e.g. \"<= 30\", \"15-45\", \"> 1 hr\", \"prep <= 10\"");
+            TimeFilter timeFilter;
+            if (recipeTime[0] != '\0' && !parse_time_filter(recipeTime, timeFilter))
+                ImGui::TextDisabled("Time not recognized, ignoring it");
+            ImGui::InputText("Directions Contain", directionsText, IM_ARRAYSIZE(directionsText));
+            ImGui::SetItemTooltip("Words, \"quoted phrases\" or stir NEAR/5 \"low heat\"");
             ImGui::Checkbox("Include recipes with lesser quantity", &include_less_equal);
+            ImGui::InputText("Advanced Query", advancedQuery, IM_ARRAYSIZE(advancedQuery));
+            ImGui::SetItemTooltip("e.g. chicken AND (garlic OR shallot) NOT peanut time<=30 rating>=4\n"
+                                  "Fields: name:, ingredient:, directions:, time, prep, cook, rating");
 	    ImGui::EndChild();
         }
         ImGui::TreePop();
     }
 
-    // Filter logic & result listbox...
-    // (keep the filtering/normalizing and listbox code from your original block here)
-	std::string filterIngredient(ingredientName);
-	std::string filterQuantity(ingredientQuantity);
-	std::string filterUnit(availableUnits[selected_unit_idx]);
-	
-	// Lowercase and trim helper
-	auto normalize = [](std::string& s) {
-	    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
-	    s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char c) { return !std::isspace(c); }));
-	    s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char c) { return !std::isspace(c); }).base(), s.end());
-	};
-
-	normalize(filterIngredient);
-	normalize(filterQuantity);
-	normalize(filterUnit);
-
-	// Convert ASCII fraction in filterQuantity to Unicode
-	std::unordered_map<std::string, std::string> ascii_to_unicode = {
-	    {"1/4", "¼"}, {"1/2", "½"}, {"3/4", "¾"},
-	    {"1/3", "⅓"}, {"2/3", "⅔"},
-	    {"1/5", "⅕"}, {"2/5", "⅖"}, {"3/5", "⅗"}, {"4/5", "⅘"},
-	    {"1/6", "⅙"}, {"5/6", "⅚"},
-	    {"1/8", "⅛"}, {"3/8", "⅜"}, {"5/8", "⅝"}, {"7/8", "⅞"}
-	};
-
-	// Handle "1 1/2" → "1½"
-	std::regex mixed_number_pattern(R"((\b\d+)\s+(\d/\d)\b)");
-	std::smatch match;
-	while (std::regex_search(filterQuantity, match, mixed_number_pattern)) {
-	    std::string whole = match[1];
-	    std::string frac = match[2];
-	    auto it = ascii_to_unicode.find(frac);
-	    if (it != ascii_to_unicode.end()) {
-		filterQuantity = filterQuantity.substr(0, match.position()) +
-				 whole + it->second +
-				 filterQuantity.substr(match.position() + match.length());
-	    } else {
-		break;
-	    }
-	}
-
-	// Handle standalone "1/2" → "½"
-	for (const auto& [ascii_frac, unicode_frac] : ascii_to_unicode) {
-	    std::regex standalone_frac(R"(\b)" + ascii_frac + R"(\b)");
-	    filterQuantity = std::regex_replace(filterQuantity, standalone_frac, unicode_frac);
-	}
-
-	// Build the filtered list
-	std::vector<std::pair<std::string, int>> currentRecipes;
-	std::vector<std::pair<std::string, std::pair<int, double>>> sortedMatches;
-
-	double targetQty = filterQuantity.empty() ? -1.0 : parse_mixed_fraction(filterQuantity);
-
-
-	for (int i = 0; i < recipes.size(); ++i) {
-	    std::string loweredName = recipes[i].name;
-	    std::transform(loweredName.begin(), loweredName.end(), loweredName.begin(), [](unsigned char c){ return std::tolower(c); });
-
-	    if (loweredName.find(currentText) == std::string::npos) continue;
-
-	    if (filterIngredient.empty() && filterQuantity.empty() && (filterUnit == " ")) {
-		currentRecipes.emplace_back(recipes[i].name, i);
-	    } else {
-		bool matchFound = false;
-		double bestQty = -1.0;
-
-		for (const auto& ing : recipes[i].ingredients) {
-		    std::string name = ing.name;
-		    std::string qty = ing.quantity;
-		    std::string unit = ing.unit;
-		    normalize(name); normalize(qty); normalize(unit);
-
-		    double ingQty = qty.empty() ? -1.0 : parse_mixed_fraction(qty);
-
-		    bool matchIngredient = filterIngredient.empty() || name.find(filterIngredient) != std::string::npos;
-		    bool matchUnit = (filterUnit == " ") || unit.find(filterUnit) != std::string::npos;
+    // Diet preset plus individual allergen exclusions; the query excludes the union of both
+    static int selected_diet_idx = 0;
+    static unsigned int excluded_categories = 0;
+    if (ImGui::TreeNode("Diet and Allergens")) {
+        const std::vector<DietInfo>& diets = diet_list();
+        if (ImGui::BeginCombo("Diet", diets[selected_diet_idx].label)) {
+            for (int i = 0; i < diets.size(); ++i) {
+                bool is_selected = (selected_diet_idx == i);
+                if (ImGui::Selectable(diets[i].label, is_selected))
+                    selected_diet_idx = i;
+                if (is_selected)
+                    ImGui::SetItemDefaultFocus();
+            }
+            ImGui::EndCombo();
+        }
+        ImGui::TextUnformatted("Exclude:");
+        const std::vector<CategoryInfo>& categories = category_list();
+        for (int i = 0; i < categories.size(); ++i) {
+            if (i % 4 != 0) ImGui::SameLine();
+            ImGui::CheckboxFlags(categories[i].label, &excluded_categories, categories[i].mask);
+        }
+        ImGui::TreePop();
+    }
 
-		    if (include_less_equal) {
-			if (matchIngredient && matchUnit && targetQty >= 0 && ingQty <= targetQty) {
-			    matchFound = true;
-			    bestQty = std::max(bestQty, ingQty); // track best match for sort
-			}
-		    } else {
-			bool matchQuantity = filterQuantity.empty() || qty.find(filterQuantity) != std::string::npos;
-			if (matchIngredient && matchQuantity && matchUnit) {
-			    matchFound = true;
-			    bestQty = ingQty;
-			}
-		    }
-		}
+    // Range boxes over the nutrition facts and the rating
+    static char nutritionText[kNutrientCount][16] = {};
+    static char ratingText[16] = "";
+    if (ImGui::TreeNode("Nutrition and Rating")) {
+        const Nutrient shown[] = {Nutrient::Calories, Nutrient::Protein, Nutrient::Fat, Nutrient::Carbohydrate,
+                                  Nutrient::Sugar, Nutrient::Fiber, Nutrient::Sodium, Nutrient::Cholesterol};
+        for (Nutrient nutrient : shown) {
+            const NutrientInfo& info = nutrient_info(nutrient);
+            char label[48];
+            std::snprintf(label, sizeof(label), "%s (%s)", info.label, info.unit);
+            char* text = nutritionText[static_cast<size_t>(nutrient)];
+            ImGui::InputText(label, text, sizeof(nutritionText[0]));
+            float lo, hi;
+            if (text[0] != '\0' && !parse_value_range(text, lo, hi)) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("ignored");
+            }
+        }
+        ImGui::InputText("Rating", ratingText, IM_ARRAYSIZE(ratingText));
+        ImGui::SetItemTooltip("e.g. \">= 4.5\", \"3-4\"; the boxes above take \">= 20\", \"<= 500\", \"10-30\"");
+        ImGui::TreePop();
+    }
 
-		if (matchFound) {
-		    if (include_less_equal)
-			sortedMatches.emplace_back(recipes[i].name, std::make_pair(i, bestQty));
-		    else
-			currentRecipes.emplace_back(recipes[i].name, i);
-		}
-	    }
-	}
+    // Cuisine category selected in the facet panel below the result count
+    static uint32_t selected_facet = FacetTree::kRoot;
+    if (selected_facet >= searchIndex.cuisines.size()) selected_facet = FacetTree::kRoot;
 
-	// If in inequality mode, sort by matched quantity descending
-	if (include_less_equal) {
-	    std::sort(sortedMatches.begin(), sortedMatches.end(),
-		      [](const auto& a, const auto& b) {
-			  return a.second.second > b.second.second;
-		      });
-	    for (const auto& entry : sortedMatches) {
-		currentRecipes.emplace_back(entry.first, entry.second.first);
-	    }
+    // Filter logic & result listbox...
+	SearchQuery query;
+	query.dish_name = dishName;
+	query.ingredient = ingredientName;
+	query.quantity = ingredientQuantity;
+	query.unit = availableUnits.empty() ? " " : availableUnits[selected_unit_idx];
+	query.time = recipeTime;
+	query.directions = directionsText;
+	query.advanced = advancedQuery;
+	query.excluded_categories = excluded_categories | diet_list()[selected_diet_idx].excluded;
+	query.facet = selected_facet;
+	for (size_t n = 0; n < kNutrientCount; ++n) query.nutrition[n] = nutritionText[n];
+	query.rating = ratingText;
+	query.similar_to = similarText;
+	query.include_less_equal = include_less_equal;
+	query.fuzzy = fuzzy_matching;
+	query.rank_by_relevance = rank_by_relevance;
+
+	// The filtered list is built on the search worker; an input or recipe list change queues a new
+	// search and the previous list stays on screen until its replacement is published
+	SearchWorker& searchWorker = search_worker();
+	static bool wake_installed = false;
+	if (!wake_installed) {
+	    searchWorker.set_on_publish([] {
+		SDL_Event wake_event;
+		SDL_zero(wake_event);
+		wake_event.type = SDL_EVENT_USER;
+		SDL_PushEvent(&wake_event);
+	    });
+	    wake_installed = true;
 	}
+	searchWorker.submit(query);
+	std::shared_ptr<const SearchOutcome> outcome = searchWorker.latest();
+	const std::vector<SearchResult>& currentRecipes = outcome->results;
 
 	// FILTERED LISTBOX
 	static int item_selected_idx = 0; // Selected entry as an index.
+	static int list_recipe_idx = -1;  // Recipe shown for that entry
         int item_highlighted_idx = -1; // Highlighted entry as an index.
 
 	// Get the remaining vertical space in the current window
         float available_height = ImGui::GetContentRegionAvail().y;
 
 	ImGui::Text("Recipes:");
+	ImGui::SameLine();
+	if (searchWorker.busy())
+	    ImGui::TextDisabled("searching...");
+	else
+	    ImGui::TextDisabled("%zu found in %.1f ms", currentRecipes.size(), outcome->millis);
+
+	// EXPLAIN view of the advanced query: estimated and actual rows and time per operator
+	if (!outcome->explain.empty() && ImGui::TreeNode("Query Plan")) {
+	    ImGui::TextUnformatted(outcome->explain.c_str());
+	    ImGui::TreePop();
+	}
+
+	// Facet panel: counts come with each search outcome, taken before the category narrows it
+	if (searchIndex.cuisines.size() > 1 && ImGui::TreeNode("Categories")) {
+	    const std::vector<uint32_t>& counts = outcome->facet_counts;
+	    char all_label[48];
+	    std::snprintf(all_label, sizeof(all_label), "All categories (%u)", counts.empty() ? 0u : counts[FacetTree::kRoot]);
+	    if (ImGui::Selectable(all_label, selected_facet == FacetTree::kRoot))
+		selected_facet = FacetTree::kRoot;
+	    if (ImGui::BeginChild("FacetChild", ImVec2(-FLT_MIN, ImGui::GetTextLineHeightWithSpacing() * 10), ImGuiChildFlags_Borders)) {
+		for (uint32_t child : searchIndex.cuisines.node(FacetTree::kRoot).children)
+		    RenderFacetNode(searchIndex.cuisines, child, counts, selected_facet);
+	    }
+	    ImGui::EndChild();
+	    if (selected_facet != FacetTree::kRoot)
+		ImGui::TextDisabled("Showing %s", searchIndex.cuisines.path(selected_facet).c_str());
+	    ImGui::TreePop();
+	}
+	available_height = ImGui::GetContentRegionAvail().y;
 
 	if (ImGui::BeginListBox("##listbox 2", ImVec2(-FLT_MIN, available_height))) {
 	    for (int n = 0; n < currentRecipes.size(); ++n) {
-		const auto& [name, originalIndex] = currentRecipes[n];
+		const int originalIndex = currentRecipes[n].recipe_id;
+		const std::string& name = recipes[originalIndex].name;
 		bool is_selected = (item_selected_idx == n);
 		ImGuiSelectableFlags flags = (item_highlighted_idx == n) ? ImGuiSelectableFlags_Highlight : 0;
 
-		std::string label = name + "###recipe_" + std::to_string(originalIndex);
-		if (ImGui::Selectable(label.c_str(), is_selected, flags))
+		// Formatted into a stack buffer, so drawing the list allocates nothing per recipe
+		char label[512];
+		if (currentRecipes[n].score > 0.0f)
+		    std::snprintf(label, sizeof(label), "%s  [%.2f]###recipe_%d", name.c_str(), currentRecipes[n].score, originalIndex);
+		else
+		    std::snprintf(label, sizeof(label), "%s###recipe_%d", name.c_str(), originalIndex);
+		if (ImGui::Selectable(label, is_selected, flags))
 		    item_selected_idx = n;
 
+		// Only a change of the list's selection replaces the displayed recipe, so one opened
+		// from the display window's "More like this" list stays up
 		if (is_selected) {
 		    ImGui::SetItemDefaultFocus();
-		    appState.current_recipe = recipes[originalIndex].name;
-		    appState.current_ingredients = recipes[originalIndex].ingredients;
-		    appState.current_directions = recipes[originalIndex].directions;
+		    if (originalIndex != list_recipe_idx) {
+			list_recipe_idx = originalIndex;
+			SelectRecipe(appState, originalIndex);
+		    }
 		}
 	    }
 	    ImGui::EndListBox();
@@ -189,6 +307,8 @@ void RenderSearchWindow(AppState& appState) {
     ImGui::PopFont();
 }
 
+static constexpr size_t kSimilarRecipeCount = 8;
+
 void RenderDisplayWindow(AppState& appState) {
 	ImGui::Begin("Display Window");
 
@@ -197,37 +317,173 @@ void RenderDisplayWindow(AppState& appState) {
     ImGui::PopFont();
     ImGui::PushFont(appState.font_normal);
 
-    std::string full_ingredients = clean_and_format_ingredients(appState.current_ingredients);
-    std::string full_directions = clean_recipe_directions(appState.current_directions);
-
-    static std::string last_directions;
+    static int last_recipe_idx = -1;
+    static uint64_t last_generation = 0;
+    static std::vector<std::pair<std::string, size_t>> ingredient_lines; // formatted line, ingredient index
     static std::vector<std::string> direction_steps;
+    static std::vector<std::vector<uint32_t>> step_mentions;
     static std::vector<char> step_checkboxes;
+    static int hovered_step = -1;
+    static std::vector<SimilarRecipe> similar_recipes;
+
+    // Formatting and entity linking only rerun when a different recipe is selected
+    if (appState.current_recipe_idx != last_recipe_idx || dataset_generation() != last_generation) {
+        last_recipe_idx = appState.current_recipe_idx;
+        last_generation = dataset_generation();
+
+        ingredient_lines.clear();
+        for (size_t i = 0; i < appState.current_ingredients.size(); ++i) {
+            std::string line = clean_and_format_ingredients({appState.current_ingredients[i]});
+            if (!line.empty() && line.back() == '\n') line.pop_back();
+            if (!line.empty()) ingredient_lines.emplace_back(line, i);
+        }
 
-    if (full_directions != last_directions) {
-        last_directions = full_directions;
-        direction_steps = split_numbered_steps(full_directions);
+        direction_steps = split_numbered_steps(clean_recipe_directions(appState.current_directions));
         step_checkboxes = std::vector<char>(direction_steps.size(), 0);
+
+        step_mentions.clear();
+        for (const std::string& step : direction_steps) {
+            std::vector<uint32_t> ids;
+            for (const EntityMatch& m : find_ingredient_mentions(step))
+                if (std::find(ids.begin(), ids.end(), m.id) == ids.end()) ids.push_back(m.id);
+            step_mentions.push_back(ids);
+        }
+        hovered_step = -1;
+
+        similar_recipes.clear();
+        if (appState.current_recipe_idx >= 0)
+            similar_recipes = searchIndex.similarity.similar(appState.current_recipe_idx, kSimilarRecipeCount);
     }
 
+    // Highlight the ingredients mentioned in the direction step under the mouse
+    auto mentioned_in_hovered_step = [&](const Ingredient& ing) {
+        if (hovered_step < 0) return false;
+        const std::vector<uint32_t>& ids = step_mentions[hovered_step];
+        auto mentioned = [&](uint32_t id) { return std::find(ids.begin(), ids.end(), id) != ids.end(); };
+        if (ing.canonical_id != kNoIngredientId && mentioned(ing.canonical_id)) return true;
+        return std::any_of(ing.tags.begin(), ing.tags.end(), mentioned);
+    };
+
     ImGui::NewLine();
-    ImGui::TextWrapped(full_ingredients.c_str());
+    for (const auto& [line, index] : ingredient_lines) {
+        if (mentioned_in_hovered_step(appState.current_ingredients[index]))
+            ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "%s", line.c_str());
+        else
+            ImGui::TextWrapped("%s", line.c_str());
+    }
     ImGui::NewLine();
 
+    int hovered_this_frame = -1;
     for (size_t i = 0; i < direction_steps.size(); ++i) {
         std::string label = "##step" + std::to_string(i);
         ImGui::Checkbox(label.c_str(), reinterpret_cast<bool*>(&step_checkboxes[i]));
         ImGui::SameLine();
         ImGui::Text("%s", direction_steps[i].c_str());
+        if (ImGui::IsItemHovered()) hovered_this_frame = static_cast<int>(i);
+
+        if (!step_mentions[i].empty()) {
+            std::string uses = "Uses:";
+            for (uint32_t id : step_mentions[i]) uses += " " + ingredientDictionary.names[id] + ",";
+            uses.pop_back();
+            ImGui::TextDisabled("%s", uses.c_str());
+        }
+    }
+    hovered_step = hovered_this_frame;
+
+    // Nearest recipes by shared canonical ingredients; selecting one shows it here
+    if (!similar_recipes.empty()) {
+        ImGui::NewLine();
+        ImGui::Separator();
+        ImGui::Text("More like this");
+        int picked = -1;
+        for (const SimilarRecipe& similar : similar_recipes) {
+            char label[160];
+            std::snprintf(label, sizeof(label), "%s  (%.0f%% shared)###similar_%u",
+                          recipes[similar.recipe_id].name.c_str(), similar.jaccard * 100.0f, similar.recipe_id);
+            if (ImGui::Selectable(label)) picked = static_cast<int>(similar.recipe_id);
+        }
+        if (picked >= 0) SelectRecipe(appState, picked);
     }
 
     ImGui::PopFont();
     ImGui::End();
 }
 
+void RenderPantryWindow(AppState& appState) {
+    ImGui::PushFont(appState.font_normal);
+    ImGui::Begin("Pantry");
+
+    static std::vector<std::string> pantryItems;
+    static char newItem[32] = "";
+    static int rank_mode = 0; // 0 = coverage, 1 = fewest missing
+
+    bool add = ImGui::InputText("##pantry_item", newItem, IM_ARRAYSIZE(newItem), ImGuiInputTextFlags_EnterReturnsTrue);
+    ImGui::SameLine();
+    add |= ImGui::Button("Add to Pantry");
+    if (add && newItem[0] != '\0') {
+        std::string item = newItem;
+        if (std::find(pantryItems.begin(), pantryItems.end(), item) == pantryItems.end())
+            pantryItems.push_back(item);
+        newItem[0] = '\0';
+    }
+
+    for (size_t i = 0; i < pantryItems.size(); ++i) {
+        ImGui::PushID(static_cast<int>(i));
+        if (ImGui::SmallButton("x")) {
+            pantryItems.erase(pantryItems.begin() + i);
+            ImGui::PopID();
+            break;
+        }
+        ImGui::SameLine();
+        ImGui::Text("%s", pantryItems[i].c_str());
+        ImGui::PopID();
+    }
+
+    ImGui::RadioButton("Best coverage", &rank_mode, 0);
+    ImGui::SameLine();
+    ImGui::RadioButton("Fewest missing", &rank_mode, 1);
+
+    // Scored on the search worker, which only reranks when the pantry, the ranking or the
+    // recipe list changes; the previous list stays on screen until the new one is published
+    SearchWorker& worker = search_worker();
+    worker.submit_pantry(pantryItems, rank_mode == 0 ? PantryRank::Coverage : PantryRank::FewestMissing);
+    std::shared_ptr<const PantryOutcome> outcome = worker.latest_pantry();
+    const std::vector<PantryMatch>& matches = outcome->matches;
+
+    static int selected_match = -1;
+    ImGui::Text("Recipes you can make:");
+    if (ImGui::BeginListBox("##pantry_matches", ImVec2(-FLT_MIN, ImGui::GetContentRegionAvail().y * 0.8f))) {
+        for (int n = 0; n < static_cast<int>(matches.size()); ++n) {
+            const PantryMatch& m = matches[n];
+            char label[512];
+            std::snprintf(label, sizeof(label), "%s (%u/%u)###pantry_%u", recipes[m.recipe_id].name.c_str(),
+                          m.have, m.required, m.recipe_id);
+            if (ImGui::Selectable(label, selected_match == n)) {
+                selected_match = n;
+                SelectRecipe(appState, m.recipe_id);
+            }
+        }
+        ImGui::EndListBox();
+    }
+
+    // Shopping list for the recipe picked from the pantry list
+    if (selected_match >= 0 && selected_match < static_cast<int>(matches.size())) {
+        std::string missing = "Missing:";
+        for (uint32_t id : pantryIndex.missing_ids(matches[selected_match].recipe_id, outcome->pantry))
+            missing += " " + ingredientDictionary.names[id] + ",";
+        if (missing.back() == ',') missing.pop_back();
+        else missing += " nothing";
+        ImGui::TextWrapped("%s", missing.c_str());
+    }
+
+    ImGui::End();
+    ImGui::PopFont();
+}
+
 void ShowMainMenuPage(AppState& appState) {
     RenderSearchWindow(appState);
     RenderDisplayWindow(appState);
+    RenderPantryWindow(appState);
 
     ImGui::Begin("Main Menu Controls");
 
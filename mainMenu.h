@@ -22,6 +22,12 @@
 #include <regex>
 
 #include "data.hpp" // outsourced helper methods for parsing CSV data
+#include "ingredientDictionary.hpp" // canonical ingredient ids used by the filters
+#include "recipeSearch.hpp" // filter pipeline behind the search window
+#include "searchIndex.hpp" // completion tries behind the input dropdowns
+#include "caseFold.hpp" // folds typed prefixes the way the completion keys are folded
+#include "searchWorker.hpp" // runs that pipeline off the UI thread
+#include "pantryIndex.hpp" // ingredient bitsets behind the pantry window
 #include "appState.h" // container struct for containing all persistent data
 #include "pdfExporter.h"
 
@@ -33,6 +39,7 @@
 
 void RenderSearchWindow(AppState& appState);
 void RenderDisplayWindow(AppState& appState);
+void RenderPantryWindow(AppState& appState);
 
 void ShowMainMenuPage(AppState& appState);	
 
@@ -0,0 +1,125 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct MemoCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+
+    double hit_rate() const {
+        uint64_t lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+    }
+};
+
+// Bounded, thread-safe memo table from a raw string to a previously computed value.
+// Entries are keyed by the hash of the string and split across independently locked shards;
+// the stored string is compared on lookup so a hash collision is treated as a miss.
+// When a shard is full its oldest entry is evicted.
+template <typename Value>
+class MemoCache {
+public:
+    explicit MemoCache(size_t capacity, size_t shard_count = 16)
+        : shards(shard_count), shard_capacity(std::max<size_t>(1, capacity / shard_count)) {
+        for (auto& shard : shards) shard = std::make_unique<Shard>();
+    }
+
+    bool lookup(const std::string& raw, Value& out) {
+        size_t hash = std::hash<std::string>{}(raw);
+        Shard& shard = shard_for(hash);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.entries.find(hash);
+            if (it != shard.entries.end() && it->second.raw == raw) {
+                out = it->second.value;
+                hits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void insert(const std::string& raw, const Value& value) {
+        size_t hash = std::hash<std::string>{}(raw);
+        Shard& shard = shard_for(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.entries.find(hash);
+        if (it != shard.entries.end()) {
+            it->second = Entry{raw, value};
+            return;
+        }
+
+        if (shard.entries.size() >= shard_capacity) {
+            shard.entries.erase(shard.order.front());
+            shard.order.pop_front();
+            evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+        shard.entries.emplace(hash, Entry{raw, value});
+        shard.order.push_back(hash);
+    }
+
+    // Returns the cached value for raw, computing and storing it on a miss
+    template <typename Compute>
+    Value get_or_compute(const std::string& raw, Compute compute) {
+        Value value;
+        if (lookup(raw, value)) return value;
+        value = compute(raw);
+        insert(raw, value);
+        return value;
+    }
+
+    MemoCacheStats stats() const {
+        MemoCacheStats s;
+        s.hits = hits.load();
+        s.misses = misses.load();
+        s.evictions = evictions.load();
+        for (const auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            s.entries += shard->entries.size();
+        }
+        return s;
+    }
+
+    void clear() {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->entries.clear();
+            shard->order.clear();
+        }
+        hits = 0;
+        misses = 0;
+        evictions = 0;
+    }
+
+private:
+    struct Entry {
+        std::string raw;
+        Value value;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<size_t, Entry> entries;
+        std::deque<size_t> order; // insertion order, oldest first
+    };
+
+    Shard& shard_for(size_t hash) { return *shards[hash % shards.size()]; }
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t shard_capacity;
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+};
@@ -0,0 +1,152 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "nutritionColumns.hpp"
+#include "data.hpp"
+
+static const NutrientInfo kNutrients[kNutrientCount] = {
+    {"calories", "Calories", "kcal"},
+    {"fat", "Fat", "g"},
+    {"satfat", "Saturated Fat", "g"},
+    {"cholesterol", "Cholesterol", "mg"},
+    {"sodium", "Sodium", "mg"},
+    {"carbs", "Carbohydrate", "g"},
+    {"fiber", "Fiber", "g"},
+    {"sugar", "Sugar", "g"},
+    {"protein", "Protein", "g"},
+    {"vitaminc", "Vitamin C", "mg"},
+    {"calcium", "Calcium", "mg"},
+    {"iron", "Iron", "mg"},
+    {"potassium", "Potassium", "mg"},
+};
+
+// Names as they appear in the nutrition text
+static const std::pair<const char*, Nutrient> kSourceNames[] = {
+    {"Total Fat", Nutrient::Fat},           {"Saturated Fat", Nutrient::SaturatedFat},
+    {"Cholesterol", Nutrient::Cholesterol}, {"Sodium", Nutrient::Sodium},
+    {"Total Carbohydrate", Nutrient::Carbohydrate}, {"Dietary Fiber", Nutrient::Fiber},
+    {"Total Sugars", Nutrient::Sugar},      {"Protein", Nutrient::Protein},
+    {"Vitamin C", Nutrient::VitaminC},      {"Calcium", Nutrient::Calcium},
+    {"Iron", Nutrient::Iron},               {"Potassium", Nutrient::Potassium},
+};
+
+const NutrientInfo& nutrient_info(Nutrient nutrient) {
+    return kNutrients[static_cast<size_t>(nutrient)];
+}
+
+bool find_nutrient(const std::string& key, Nutrient& nutrient) {
+    for (size_t n = 0; n < kNutrientCount; ++n) {
+        if (key == kNutrients[n].key) {
+            nutrient = static_cast<Nutrient>(n);
+            return true;
+        }
+    }
+    return false;
+}
+
+NutritionFacts parse_nutrition(const std::string& text) {
+    NutritionFacts facts;
+    if (text.empty()) {
+        facts.fill(std::numeric_limits<float>::quiet_NaN());
+        return facts;
+    }
+    facts.fill(0.0f);
+
+    // Entries are "Name amount unit [percent]" separated by ", "; percents may hold a comma themselves
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find(", ", start);
+        if (end == std::string::npos) end = text.size();
+        for (const auto& [name, nutrient] : kSourceNames) {
+            size_t len = std::strlen(name);
+            if (end - start > len && text.compare(start, len, name) == 0 && text[start + len] == ' ') {
+                facts[static_cast<size_t>(nutrient)] = static_cast<float>(std::atof(text.c_str() + start + len + 1));
+                break;
+            }
+        }
+        start = end + 2;
+    }
+
+    facts[static_cast<size_t>(Nutrient::Calories)] = 9.0f * facts[static_cast<size_t>(Nutrient::Fat)] +
+                                                      4.0f * facts[static_cast<size_t>(Nutrient::Carbohydrate)] +
+                                                      4.0f * facts[static_cast<size_t>(Nutrient::Protein)];
+    return facts;
+}
+
+void NutritionColumns::clear() {
+    for (std::vector<float>& column : columns) column.clear();
+    count = 0;
+}
+
+void NutritionColumns::build() {
+    clear();
+    for (std::vector<float>& column : columns) column.reserve((recipes.size() + 63) / 64 * 64);
+    for (uint32_t r = 0; r < recipes.size(); ++r) add_recipe(r);
+}
+
+void NutritionColumns::add_recipe(uint32_t recipe_id) {
+    const Recipe& recipe = recipes[recipe_id];
+    count = recipe_id + 1;
+    const size_t padded = (count + 63) / 64 * 64;
+    for (std::vector<float>& column : columns) column.resize(padded, std::numeric_limits<float>::quiet_NaN());
+
+    for (size_t n = 0; n < kNutrientCount; ++n) columns[n][recipe_id] = recipe.nutrients[n];
+    columns[kRatingColumn][recipe_id] = recipe.rating >= 0 ? recipe.rating : std::numeric_limits<float>::quiet_NaN();
+}
+
+std::vector<uint64_t> NutritionColumns::all_mask() const {
+    std::vector<uint64_t> masks((count + 63) / 64, ~uint64_t(0));
+    if (count % 64) masks.back() = (uint64_t(1) << (count % 64)) - 1;
+    return masks;
+}
+
+// lo <= v <= hi for 64 values into one mask word; ordered compares are false for NaN
+void NutritionColumns::apply(const ColumnPredicate& predicate, std::vector<uint64_t>& masks) const {
+    const float* values = columns[predicate.column].data();
+#if defined(__SSE2__)
+    const __m128 lo = _mm_set1_ps(predicate.lo);
+    const __m128 hi = _mm_set1_ps(predicate.hi);
+#endif
+    for (size_t w = 0; w < masks.size(); ++w) {
+        if (masks[w] == 0) continue;
+        const float* block = values + w * 64;
+        uint64_t bits = 0;
+#if defined(__SSE2__)
+        for (int lane = 0; lane < 64; lane += 4) {
+            __m128 v = _mm_loadu_ps(block + lane);
+            __m128 in = _mm_and_ps(_mm_cmpge_ps(v, lo), _mm_cmple_ps(v, hi));
+            bits |= static_cast<uint64_t>(_mm_movemask_ps(in)) << lane;
+        }
+#else
+        for (int lane = 0; lane < 64; ++lane)
+            bits |= static_cast<uint64_t>(block[lane] >= predicate.lo && block[lane] <= predicate.hi) << lane;
+#endif
+        masks[w] &= bits;
+    }
+}
+
+std::vector<uint32_t> NutritionColumns::filter(const std::vector<ColumnPredicate>& predicates) const {
+    std::vector<uint64_t> masks = all_mask();
+    for (const ColumnPredicate& predicate : predicates) apply(predicate, masks);
+
+    std::vector<uint32_t> ids;
+    for (size_t w = 0; w < masks.size(); ++w) {
+        for (uint64_t bits = masks[w]; bits; bits &= bits - 1)
+            ids.push_back(static_cast<uint32_t>(w * 64 + __builtin_ctzll(bits)));
+    }
+    return ids;
+}
+
+size_t NutritionColumns::count_matching(const ColumnPredicate& predicate) const {
+    std::vector<uint64_t> masks = all_mask();
+    apply(predicate, masks);
+    size_t n = 0;
+    for (uint64_t word : masks) n += __builtin_popcountll(word);
+    return n;
+}
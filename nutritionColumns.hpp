@@ -0,0 +1,63 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-serving nutrition facts from the CSV's nutrition column
+enum class Nutrient : uint8_t {
+    Calories, Fat, SaturatedFat, Cholesterol, Sodium, Carbohydrate, Fiber, Sugar, Protein,
+    VitaminC, Calcium, Iron, Potassium, Count
+};
+constexpr size_t kNutrientCount = static_cast<size_t>(Nutrient::Count);
+using NutritionFacts = std::array<float, kNutrientCount>;
+
+struct NutrientInfo {
+    const char* key;    // field name in the query language ("protein")
+    const char* label;  // as shown in the UI ("Protein")
+    const char* unit;   // "g", "mg" or "kcal"
+};
+
+const NutrientInfo& nutrient_info(Nutrient nutrient);
+// Looks up a query language key; false if there is no such nutrient
+bool find_nutrient(const std::string& key, Nutrient& nutrient);
+
+// "Total Fat 5g 7%, Sodium 33mg 1%, ..." -> facts. The source leaves out nutrients with no
+// amount, so those are 0; an empty text gives NaN for everything. Calories are derived as
+// 9 kcal per gram of fat and 4 per gram of carbohydrate or protein.
+NutritionFacts parse_nutrition(const std::string& text);
+
+// Inclusive range on one float column; NaN values never match
+struct ColumnPredicate {
+    uint32_t column;
+    float lo;
+    float hi;
+};
+
+// Contiguous float columns, one per nutrient followed by the rating, indexed by recipe id and
+// padded with NaN to a multiple of 64 recipes. A predicate is evaluated 64 recipes at a time
+// into one mask word with SIMD compares, and predicates combine by ANDing mask words.
+class NutritionColumns {
+public:
+    static constexpr uint32_t kRatingColumn = static_cast<uint32_t>(kNutrientCount);
+    static constexpr uint32_t kColumnCount = kRatingColumn + 1;
+
+    void build();
+    void add_recipe(uint32_t recipe_id);
+    void clear();
+
+    float value(uint32_t column, uint32_t recipe_id) const { return columns[column][recipe_id]; }
+    size_t recipe_count() const { return count; }
+
+    // Sorted ids of the recipes satisfying every predicate
+    std::vector<uint32_t> filter(const std::vector<ColumnPredicate>& predicates) const;
+    size_t count_matching(const ColumnPredicate& predicate) const;
+
+private:
+    std::vector<uint64_t> all_mask() const;
+    void apply(const ColumnPredicate& predicate, std::vector<uint64_t>& masks) const;
+
+    std::array<std::vector<float>, kColumnCount> columns;
+    size_t count = 0;
+};
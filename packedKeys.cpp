@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include "packedKeys.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+// AVX2 is compiled with a target attribute and picked at run time, so the default flags still
+// produce a binary that runs on any x86-64
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PACKED_KEYS_AVX2 1
+#include <immintrin.h>
+#endif
+
+void PackedKeys::add(uint32_t record_id, std::string_view key) {
+    blob.resize(text_size);
+    if (!owners.empty() && owners.back() != record_id) {
+        for (size_t k = last_record_first_key; k < starts.size(); ++k) next_record[k] = static_cast<uint32_t>(starts.size());
+        last_record_first_key = starts.size();
+    }
+    starts.push_back(static_cast<uint32_t>(text_size));
+    owners.push_back(record_id);
+    next_record.push_back(kLastRecord);
+    blob.append(key);
+    blob.push_back('\0');
+    text_size = blob.size();
+    blob.append(kPadding, '\0');
+}
+
+void PackedKeys::clear() {
+    blob.clear();
+    text_size = 0;
+    starts.clear();
+    owners.clear();
+    next_record.clear();
+    last_record_first_key = 0;
+}
+
+size_t PackedKeys::memory_bytes() const {
+    return blob.capacity() + (starts.capacity() + owners.capacity() + next_record.capacity()) * sizeof(uint32_t);
+}
+
+namespace {
+
+struct ScanInput {
+    const char* text;
+    size_t text_size;
+    size_t padded_size;
+    const std::vector<uint32_t>& starts;
+    const std::vector<uint32_t>& next_record;
+    std::string_view needle;
+};
+
+// Records the key holding the match at pos and returns where the scan continues: the first key
+// of the next record, since one match per record is enough. Matches only move forward, so the
+// key is found by galloping from first_key, the first key the scan has not passed yet.
+size_t record_match(const ScanInput& in, size_t pos, size_t& first_key, std::vector<uint32_t>& keys) {
+    const size_t count = in.starts.size();
+    size_t step = 1;
+    while (first_key + step < count && in.starts[first_key + step] <= pos) step *= 2;
+    auto begin = in.starts.begin() + static_cast<std::ptrdiff_t>(first_key + step / 2);
+    auto end = in.starts.begin() + static_cast<std::ptrdiff_t>(std::min(first_key + step, count));
+    size_t key = static_cast<size_t>(std::upper_bound(begin, end, pos) - in.starts.begin()) - 1;
+    keys.push_back(static_cast<uint32_t>(key));
+
+    if (in.next_record[key] == PackedKeys::kLastRecord) {
+        first_key = count;
+        return in.text_size;
+    }
+    first_key = in.next_record[key];
+    return in.starts[first_key];
+}
+
+// Bytes between the first and the last of a candidate, which the SIMD filter has not compared
+bool middle_matches(const ScanInput& in, size_t pos) {
+    const size_t k = in.needle.size();
+    return k <= 2 || std::memcmp(in.text + pos + 1, in.needle.data() + 1, k - 2) == 0;
+}
+
+// std::string_view::find from position i on; also the tail of the SIMD kernels
+void scan_scalar(const ScanInput& in, size_t i, size_t first_key, std::vector<uint32_t>& keys) {
+    std::string_view text(in.text, in.text_size);
+    size_t pos;
+    while (i < in.text_size && (pos = text.find(in.needle, i)) != std::string_view::npos)
+        i = record_match(in, pos, first_key, keys);
+}
+
+#if defined(__SSE2__)
+void scan_sse2(const ScanInput& in, std::vector<uint32_t>& keys) {
+    const size_t k = in.needle.size();
+    const __m128i first = _mm_set1_epi8(in.needle.front());
+    const __m128i last = _mm_set1_epi8(in.needle.back());
+    size_t i = 0, first_key = 0;
+    // 16 candidate positions per step; the last-byte load ends k - 1 bytes further on
+    while (i < in.text_size && i + k + 15 <= in.padded_size) {
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in.text + i));
+        __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in.text + i + k - 1));
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last))));
+        size_t next = i + 16;
+        for (; mask != 0; mask &= mask - 1) {
+            size_t pos = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (pos + k <= in.text_size && middle_matches(in, pos)) {
+                next = record_match(in, pos, first_key, keys);
+                break;
+            }
+        }
+        i = next;
+    }
+    scan_scalar(in, i, first_key, keys);
+}
+#endif
+
+#if defined(PACKED_KEYS_AVX2)
+__attribute__((target("avx2"))) void scan_avx2(const ScanInput& in, std::vector<uint32_t>& keys) {
+    const size_t k = in.needle.size();
+    const __m256i first = _mm256_set1_epi8(in.needle.front());
+    const __m256i last = _mm256_set1_epi8(in.needle.back());
+    size_t i = 0, first_key = 0;
+    while (i < in.text_size && i + k + 31 <= in.padded_size) {
+        __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.text + i));
+        __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.text + i + k - 1));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last))));
+        size_t next = i + 32;
+        for (; mask != 0; mask &= mask - 1) {
+            size_t pos = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (pos + k <= in.text_size && middle_matches(in, pos)) {
+                next = record_match(in, pos, first_key, keys);
+                break;
+            }
+        }
+        i = next;
+    }
+    scan_scalar(in, i, first_key, keys);
+}
+#endif
+
+} // namespace
+
+bool substring_kernel_supported(SubstringKernel kernel) {
+    switch (kernel) {
+    case SubstringKernel::Scalar:
+        return true;
+    case SubstringKernel::Sse2:
+#if defined(__SSE2__)
+        return true;
+#else
+        return false;
+#endif
+    case SubstringKernel::Avx2:
+#if defined(PACKED_KEYS_AVX2)
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+SubstringKernel best_substring_kernel() {
+    static const SubstringKernel best = substring_kernel_supported(SubstringKernel::Avx2) ? SubstringKernel::Avx2
+                                      : substring_kernel_supported(SubstringKernel::Sse2) ? SubstringKernel::Sse2
+                                      : SubstringKernel::Scalar;
+    return best;
+}
+
+std::vector<uint32_t> PackedKeys::find(std::string_view needle, SubstringKernel kernel) const {
+    std::vector<uint32_t> result;
+    if (needle.empty()) {
+        std::unique_copy(owners.begin(), owners.end(), std::back_inserter(result));
+        return result;
+    }
+    // A NUL would match across the separators
+    if (needle.find('\0') != std::string_view::npos || needle.size() > text_size) return result;
+
+    ScanInput in{blob.data(), text_size, blob.size(), starts, next_record, needle};
+    std::vector<uint32_t> keys;
+    if (!substring_kernel_supported(kernel)) kernel = SubstringKernel::Scalar;
+    switch (kernel) {
+#if defined(PACKED_KEYS_AVX2)
+    case SubstringKernel::Avx2:
+        scan_avx2(in, keys);
+        break;
+#endif
+#if defined(__SSE2__)
+    case SubstringKernel::Sse2:
+        scan_sse2(in, keys);
+        break;
+#endif
+    default:
+        scan_scalar(in, 0, 0, keys);
+        break;
+    }
+
+    // The scan resumes at the next record after each match, so owners come out distinct and ascending
+    result.reserve(keys.size());
+    for (uint32_t key : keys) result.push_back(owners[key]);
+    return result;
+}
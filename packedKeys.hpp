@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class SubstringKernel { Scalar, Sse2, Avx2 };
+
+// Fastest kernel this CPU runs: AVX2 when available at run time, else SSE2, else scalar
+SubstringKernel best_substring_kernel();
+bool substring_kernel_supported(SubstringKernel kernel);
+
+// Search keys of many records packed into one NUL-separated buffer, so a substring query is a
+// single pass over contiguous memory instead of one std::string::find per key. The SIMD kernels
+// follow Wojciech Mula's first-and-last-byte filter: a block of positions is compared against
+// the needle's first byte and, shifted by the needle length, its last byte; only positions where
+// both match are verified with memcmp. A match skips straight to the next record's keys.
+class PackedKeys {
+public:
+    // Records must be added in ascending id order; a record may have several keys
+    void add(uint32_t record_id, std::string_view key);
+    void clear();
+
+    // Sorted ids of the records with a key containing needle, which must already be folded
+    // (see fold_case). An empty needle matches every record with a key.
+    std::vector<uint32_t> find(std::string_view needle) const { return find(needle, best_substring_kernel()); }
+    std::vector<uint32_t> find(std::string_view needle, SubstringKernel kernel) const;
+
+    size_t key_count() const { return starts.size(); }
+    size_t memory_bytes() const;
+
+    // Zero bytes after the last key, so a block load starting inside the text never reads past it
+    static constexpr size_t kPadding = 32;
+    static constexpr uint32_t kLastRecord = UINT32_MAX;
+
+private:
+    std::string blob;              // keys, each followed by '\0', then kPadding zero bytes
+    size_t text_size = 0;          // blob size without the padding
+    std::vector<uint32_t> starts;  // blob offset of each key
+    std::vector<uint32_t> owners;  // record id of each key, ascending
+    std::vector<uint32_t> next_record; // per key: index of the next record's first key, kLastRecord
+                                       // for the keys of the last record added
+    size_t last_record_first_key = 0;
+};
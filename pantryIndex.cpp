@@ -0,0 +1,225 @@
+#include <algorithm>
+
+#include "pantryIndex.hpp"
+#include "ingredientDictionary.hpp"
+#include "threadPool.hpp"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+// Compiled with target attributes and picked at run time, so the default flags still produce a
+// binary that runs on any x86-64; without them __builtin_popcountll is a libgcc call
+#define PANTRY_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+PantryIndex pantryIndex;
+
+void PantrySet::add(uint32_t id) {
+    if (id < PantryIndex::kDenseIds) {
+        if (dense.empty()) dense.assign(PantryIndex::kDenseWords, 0);
+        dense[id / 64] |= uint64_t(1) << (id % 64);
+    } else {
+        auto it = std::lower_bound(sparse.begin(), sparse.end(), id);
+        if (it == sparse.end() || *it != id) sparse.insert(it, id);
+    }
+}
+
+bool PantrySet::contains(uint32_t id) const {
+    if (id < PantryIndex::kDenseIds) return !dense.empty() && (dense[id / 64] >> (id % 64)) & 1;
+    return std::binary_search(sparse.begin(), sparse.end(), id);
+}
+
+bool PantrySet::empty() const {
+    return sparse.empty() && std::all_of(dense.begin(), dense.end(), [](uint64_t w) { return w == 0; });
+}
+
+PantrySet make_pantry_set(const std::vector<std::string>& items) {
+    PantrySet pantry;
+    pantry.dense.assign(PantryIndex::kDenseWords, 0);
+    for (const std::string& item : items) {
+        uint32_t id = find_ingredient_id(item);
+        if (id != kNoIngredientId) pantry.add(id);
+    }
+    return pantry;
+}
+
+void PantryIndex::clear() {
+    dense_bits.clear();
+    sparse_offsets.assign(1, 0);
+    sparse_ids.clear();
+    required.clear();
+}
+
+void PantryIndex::build() {
+    clear();
+    dense_bits.reserve(recipes.size() * kDenseWords);
+    required.reserve(recipes.size());
+    for (uint32_t r = 0; r < recipes.size(); ++r) add_recipe(r);
+}
+
+void PantryIndex::add_recipe(uint32_t recipe_id) {
+    if (sparse_offsets.empty()) sparse_offsets.assign(1, 0);
+
+    // A recipe needs the canonical ingredient of each of its lines
+    std::vector<uint32_t> ids;
+    for (const Ingredient& ing : recipes[recipe_id].ingredients) {
+        if (ing.canonical_id != kNoIngredientId) ids.push_back(ing.canonical_id);
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    dense_bits.resize(dense_bits.size() + kDenseWords, 0);
+    uint64_t* bits = &dense_bits[static_cast<size_t>(recipe_id) * kDenseWords];
+    for (uint32_t id : ids) {
+        if (id < kDenseIds) bits[id / 64] |= uint64_t(1) << (id % 64);
+        else sparse_ids.push_back(id);
+    }
+    sparse_offsets.push_back(static_cast<uint32_t>(sparse_ids.size()));
+    required.push_back(static_cast<uint32_t>(ids.size()));
+}
+
+namespace {
+
+constexpr size_t kRowWords = PantryIndex::kDenseWords;
+
+// have[r] = popcount(rows[r] & pantry) for r in [begin, end); rows are kRowWords words each
+void count_rows_scalar(const uint64_t* rows, const uint64_t* pantry, size_t begin, size_t end, uint32_t* have) {
+    for (size_t r = begin; r < end; ++r) {
+        const uint64_t* bits = rows + r * kRowWords;
+        uint32_t n = 0;
+        for (size_t w = 0; w < kRowWords; ++w) n += __builtin_popcountll(bits[w] & pantry[w]);
+        have[r] = n;
+    }
+}
+
+#if defined(PANTRY_X86_KERNELS)
+__attribute__((target("popcnt"))) void count_rows_popcnt(const uint64_t* rows, const uint64_t* pantry,
+                                                         size_t begin, size_t end, uint32_t* have) {
+    for (size_t r = begin; r < end; ++r) {
+        const uint64_t* bits = rows + r * kRowWords;
+        uint32_t n = 0;
+        for (size_t w = 0; w < kRowWords; ++w) n += static_cast<uint32_t>(_mm_popcnt_u64(bits[w] & pantry[w]));
+        have[r] = n;
+    }
+}
+
+// Each byte's bit count is looked up per nibble with vpshufb, then vpsadbw sums the bytes of
+// every 64-bit lane; a row is two 256-bit halves
+__attribute__((target("avx2"))) inline __m256i byte_popcounts_avx2(__m256i v) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+    __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low_nibbles));
+    __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibbles));
+    return _mm256_add_epi8(low, high);
+}
+
+__attribute__((target("avx2"))) void count_rows_avx2(const uint64_t* rows, const uint64_t* pantry, size_t begin,
+                                                     size_t end, uint32_t* have) {
+    static_assert(kRowWords == 8, "the AVX2 kernel takes a row as two 256-bit halves");
+    const __m256i pantry_low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pantry));
+    const __m256i pantry_high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pantry + 4));
+    for (size_t r = begin; r < end; ++r) {
+        const __m256i* bits = reinterpret_cast<const __m256i*>(rows + r * kRowWords);
+        __m256i counts = _mm256_add_epi8(byte_popcounts_avx2(_mm256_and_si256(_mm256_loadu_si256(bits), pantry_low)),
+                                         byte_popcounts_avx2(_mm256_and_si256(_mm256_loadu_si256(bits + 1), pantry_high)));
+        __m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+        __m128i halves = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+        have[r] = static_cast<uint32_t>(_mm_cvtsi128_si64(halves) + _mm_extract_epi64(halves, 1));
+    }
+}
+#endif
+
+} // namespace
+
+bool popcount_kernel_supported(PopcountKernel kernel) {
+    switch (kernel) {
+    case PopcountKernel::Scalar:
+        return true;
+    case PopcountKernel::Popcnt:
+#if defined(PANTRY_X86_KERNELS)
+        return __builtin_cpu_supports("popcnt");
+#else
+        return false;
+#endif
+    case PopcountKernel::Avx2:
+#if defined(PANTRY_X86_KERNELS)
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+PopcountKernel best_popcount_kernel() {
+    static const PopcountKernel best = popcount_kernel_supported(PopcountKernel::Avx2)     ? PopcountKernel::Avx2
+                                       : popcount_kernel_supported(PopcountKernel::Popcnt) ? PopcountKernel::Popcnt
+                                       : PopcountKernel::Scalar;
+    return best;
+}
+
+std::vector<PantryMatch> PantryIndex::rank(const PantrySet& pantry, PantryRank order, PopcountKernel kernel) const {
+    const size_t count = required.size();
+    std::vector<uint32_t> have(count, 0);
+
+    uint64_t pantry_bits[kDenseWords] = {};
+    if (!pantry.dense.empty()) std::copy(pantry.dense.begin(), pantry.dense.end(), pantry_bits);
+
+    // AND + popcount over the fixed-width rows, then the few sparse ids of each recipe
+    if (!popcount_kernel_supported(kernel)) kernel = PopcountKernel::Scalar;
+    parallel_for(count, [&](size_t begin, size_t end) {
+        switch (kernel) {
+#if defined(PANTRY_X86_KERNELS)
+        case PopcountKernel::Avx2:
+            count_rows_avx2(dense_bits.data(), pantry_bits, begin, end, have.data());
+            break;
+        case PopcountKernel::Popcnt:
+            count_rows_popcnt(dense_bits.data(), pantry_bits, begin, end, have.data());
+            break;
+#endif
+        default:
+            count_rows_scalar(dense_bits.data(), pantry_bits, begin, end, have.data());
+            break;
+        }
+        if (pantry.sparse.empty()) return;
+        for (size_t r = begin; r < end; ++r) {
+            for (uint32_t k = sparse_offsets[r]; k < sparse_offsets[r + 1]; ++k)
+                have[r] += std::binary_search(pantry.sparse.begin(), pantry.sparse.end(), sparse_ids[k]);
+        }
+    });
+
+    std::vector<PantryMatch> matches;
+    for (uint32_t r = 0; r < count; ++r) {
+        if (have[r] > 0) matches.push_back({r, have[r], required[r]});
+    }
+
+    // Coverage compares have/required without dividing: a.have * b.required > b.have * a.required
+    auto by_coverage = [](const PantryMatch& a, const PantryMatch& b) {
+        uint64_t lhs = uint64_t(a.have) * b.required, rhs = uint64_t(b.have) * a.required;
+        if (lhs != rhs) return lhs > rhs;
+        return a.have > b.have;
+    };
+    auto by_missing = [](const PantryMatch& a, const PantryMatch& b) {
+        if (a.missing() != b.missing()) return a.missing() < b.missing();
+        return a.have > b.have;
+    };
+    if (order == PantryRank::Coverage)
+        std::stable_sort(matches.begin(), matches.end(), by_coverage);
+    else
+        std::stable_sort(matches.begin(), matches.end(), by_missing);
+    return matches;
+}
+
+std::vector<uint32_t> PantryIndex::missing_ids(uint32_t recipe_id, const PantrySet& pantry) const {
+    std::vector<uint32_t> missing;
+    if (recipe_id >= required.size()) return missing;
+
+    const uint64_t* bits = &dense_bits[static_cast<size_t>(recipe_id) * kDenseWords];
+    for (uint32_t id = 0; id < kDenseIds; ++id) {
+        if ((bits[id / 64] >> (id % 64)) & 1 && !pantry.contains(id)) missing.push_back(id);
+    }
+    for (uint32_t k = sparse_offsets[recipe_id]; k < sparse_offsets[recipe_id + 1]; ++k) {
+        if (!pantry.contains(sparse_ids[k])) missing.push_back(sparse_ids[k]);
+    }
+    return missing;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "data.hpp"
+
+// Set of canonical ingredient ids the user has on hand, split like the recipe sets below
+struct PantrySet {
+    std::vector<uint64_t> dense;   // bit per id below PantryIndex::kDenseIds
+    std::vector<uint32_t> sparse;  // sorted ids at or above it
+
+    void add(uint32_t id);
+    bool contains(uint32_t id) const;
+    bool empty() const;
+};
+
+struct PantryMatch {
+    uint32_t recipe_id;
+    uint32_t have;      // required ingredients found in the pantry
+    uint32_t required;  // distinct canonical ingredients of the recipe
+
+    uint32_t missing() const { return required - have; }
+};
+
+enum class PantryRank { Coverage, FewestMissing };
+
+// Kernels for the bitset AND + popcount of the scoring pass: AVX2 nibble-table popcount (Mula),
+// the hardware popcnt instruction, or the portable __builtin_popcountll loop
+enum class PopcountKernel { Scalar, Popcnt, Avx2 };
+
+// Fastest kernel this CPU runs, picked at run time like best_substring_kernel
+PopcountKernel best_popcount_kernel();
+bool popcount_kernel_supported(PopcountKernel kernel);
+
+// Per-recipe ingredient sets for pantry scoring. Dictionary ids are handed out by descending
+// frequency, so the first kDenseIds ids cover almost every ingredient line and are stored as a
+// fixed-width bitset per recipe; the long tail goes into a short sorted list per recipe.
+class PantryIndex {
+public:
+    static constexpr uint32_t kDenseIds = 512;
+    static constexpr size_t kDenseWords = kDenseIds / 64;
+
+    void build();
+    void add_recipe(uint32_t recipe_id);
+    void clear();
+
+    // Scores every recipe against the pantry; recipes with nothing on hand are left out
+    std::vector<PantryMatch> rank(const PantrySet& pantry, PantryRank order) const {
+        return rank(pantry, order, best_popcount_kernel());
+    }
+    std::vector<PantryMatch> rank(const PantrySet& pantry, PantryRank order, PopcountKernel kernel) const;
+
+    // Canonical ingredients of a recipe that the pantry lacks
+    std::vector<uint32_t> missing_ids(uint32_t recipe_id, const PantrySet& pantry) const;
+
+    size_t recipe_count() const { return required.size(); }
+
+private:
+    std::vector<uint64_t> dense_bits;      // kDenseWords words per recipe
+    std::vector<uint32_t> sparse_offsets;  // recipe -> range in sparse_ids (recipe_count + 1 entries)
+    std::vector<uint32_t> sparse_ids;
+    std::vector<uint32_t> required;
+};
+
+extern PantryIndex pantryIndex;
+
+// Resolves each pantry entry to the one dictionary id it names. Substring expansion is left to
+// the search box: a pantry with "salt" does not have "unsalted butter", nor "egg" "eggplant".
+PantrySet make_pantry_set(const std::vector<std::string>& items);
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <map>
+
+#include "positionalIndex.hpp"
+#include "postingList.hpp"
+#include "symSpell.hpp"
+#include "threadPool.hpp"
+
+using TermPositions = std::vector<std::pair<std::string, std::vector<uint32_t>>>;
+
+static void put_varint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static uint32_t get_varint(const std::vector<uint8_t>& in, size_t& offset) {
+    uint32_t value = 0;
+    int shift = 0;
+    while (true) {
+        uint8_t byte = in[offset++];
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+        shift += 7;
+    }
+}
+
+// Word positions of every distinct term of a text, terms in sorted order
+static TermPositions tokenize(const std::string& text) {
+    std::map<std::string, std::vector<uint32_t>> grouped;
+    std::vector<std::string> words = split_vocabulary_words(text);
+    for (uint32_t pos = 0; pos < words.size(); ++pos) grouped[words[pos]].push_back(pos);
+    return TermPositions(grouped.begin(), grouped.end());
+}
+
+void PositionalIndex::clear() {
+    term_ids.clear();
+    streams.clear();
+}
+
+void PositionalIndex::append(uint32_t recipe_id, const TermPositions& terms) {
+    for (const auto& [term, positions] : terms) {
+        auto [it, added] = term_ids.emplace(term, static_cast<uint32_t>(streams.size()));
+        if (added) streams.emplace_back();
+        Stream& stream = streams[it->second];
+
+        put_varint(stream.bytes, stream.doc_count == 0 ? recipe_id : recipe_id - stream.last_doc);
+        put_varint(stream.bytes, static_cast<uint32_t>(positions.size()));
+        uint32_t previous = 0;
+        for (uint32_t pos : positions) {
+            put_varint(stream.bytes, pos - previous);
+            previous = pos;
+        }
+        stream.last_doc = recipe_id;
+        ++stream.doc_count;
+    }
+}
+
+void PositionalIndex::build(const std::vector<const std::string*>& texts) {
+    clear();
+    // Tokenizing dominates, so it runs on the pool; appending stays serial to keep streams in id order
+    std::vector<TermPositions> tokenized(texts.size());
+    parallel_for(texts.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) tokenized[i] = tokenize(*texts[i]);
+    });
+    for (uint32_t r = 0; r < tokenized.size(); ++r) append(r, tokenized[r]);
+}
+
+void PositionalIndex::add_document(uint32_t recipe_id, const std::string& text) {
+    append(recipe_id, tokenize(text));
+}
+
+size_t PositionalIndex::memory_bytes() const {
+    size_t bytes = 0;
+    for (const Stream& stream : streams) bytes += stream.bytes.size() + sizeof(Stream);
+    return bytes;
+}
+
+const PositionalIndex::Stream* PositionalIndex::find(const std::string& term) const {
+    auto it = term_ids.find(term);
+    return it == term_ids.end() ? nullptr : &streams[it->second];
+}
+
+uint32_t PositionalIndex::document_frequency(const std::string& term) const {
+    const Stream* stream = find(term);
+    return stream ? stream->doc_count : 0;
+}
+
+bool PositionalIndex::Cursor::next() {
+    if (!stream || seen == stream->doc_count) return false;
+    uint32_t delta = get_varint(stream->bytes, offset);
+    doc = seen == 0 ? delta : doc + delta;
+    ++seen;
+
+    uint32_t count = get_varint(stream->bytes, offset);
+    positions.resize(count);
+    uint32_t pos = 0;
+    for (uint32_t k = 0; k < count; ++k) {
+        pos += get_varint(stream->bytes, offset);
+        positions[k] = pos;
+    }
+    return true;
+}
+
+std::vector<PositionalIndex::Occurrences> PositionalIndex::occurrences(const std::vector<std::string>& words) const {
+    std::vector<Occurrences> result;
+    if (words.empty()) return result;
+
+    std::vector<Cursor> cursors;
+    for (const std::string& word : words) {
+        const Stream* stream = find(word);
+        if (!stream) return result;
+        cursors.emplace_back(stream);
+        if (!cursors.back().next()) return result;
+    }
+
+    // Advance the cursors in lockstep to documents they all contain
+    while (true) {
+        uint32_t target = 0;
+        for (const Cursor& c : cursors) target = std::max(target, c.doc);
+        bool aligned = true;
+        for (Cursor& c : cursors) {
+            while (c.doc < target) {
+                if (!c.next()) return result;
+            }
+            aligned &= c.doc == target;
+        }
+        if (!aligned) continue;
+
+        // Start positions p with word i at p + i for every i
+        std::vector<uint32_t> starts;
+        for (uint32_t start : cursors[0].positions) {
+            bool match = true;
+            for (size_t i = 1; i < cursors.size() && match; ++i)
+                match = std::binary_search(cursors[i].positions.begin(), cursors[i].positions.end(), start + i);
+            if (match) starts.push_back(start);
+        }
+        if (!starts.empty()) result.push_back({target, std::move(starts)});
+        if (!cursors[0].next()) return result;
+    }
+}
+
+std::vector<uint32_t> PositionalIndex::phrase(const std::vector<std::string>& words) const {
+    std::vector<uint32_t> result;
+    for (const Occurrences& o : occurrences(words)) result.push_back(o.doc);
+    return result;
+}
+
+std::vector<uint32_t> PositionalIndex::near(const std::vector<std::string>& a, const std::vector<std::string>& b,
+                                            uint32_t window) const {
+    std::vector<uint32_t> result;
+    std::vector<Occurrences> in_a = occurrences(a), in_b = occurrences(b);
+    const uint32_t length_a = static_cast<uint32_t>(a.size()), length_b = static_cast<uint32_t>(b.size());
+    size_t x = 0, y = 0;
+    while (x < in_a.size() && y < in_b.size()) {
+        if (in_a[x].doc < in_b[y].doc) { ++x; continue; }
+        if (in_b[y].doc < in_a[x].doc) { ++y; continue; }
+
+        // Two-pointer walk for the closest pair of spans; the one starting first cannot get closer
+        // to any later span of the other side, so it is dropped
+        const std::vector<uint32_t>& sa = in_a[x].starts;
+        const std::vector<uint32_t>& sb = in_b[y].starts;
+        size_t i = 0, j = 0;
+        bool close = false;
+        while (i < sa.size() && j < sb.size() && !close) {
+            uint32_t pa = sa[i], pb = sb[j];
+            uint32_t gap = pa < pb ? (pb > pa + length_a - 1 ? pb - (pa + length_a - 1) : 0)
+                                   : (pa > pb + length_b - 1 ? pa - (pb + length_b - 1) : 0);
+            close = gap <= window;
+            if (pa < pb) ++i;
+            else ++j;
+        }
+        if (close) result.push_back(in_a[x].doc);
+        ++x;
+        ++y;
+    }
+    return result;
+}
+
+// "NEAR" or "NEAR/<digits>" exactly; window is set to the distance, 5 when none is given
+static bool near_operator(const std::string& token, uint32_t& window) {
+    if (token.compare(0, 4, "NEAR") != 0) return false;
+    if (token.size() == 4) {
+        window = 5;
+        return true;
+    }
+    if (token.size() == 5 || token[4] != '/') return false;
+    if (!std::all_of(token.begin() + 5, token.end(), [](unsigned char c) { return std::isdigit(c); })) return false;
+    window = static_cast<uint32_t>(std::min(std::strtoul(token.c_str() + 5, nullptr, 10), 100000ul));
+    return true;
+}
+
+bool PositionalIndex::search(const std::string& query, std::vector<uint32_t>& ids) const {
+    ids.clear();
+
+    // One token stream: a quoted phrase is a single operand, a bare token gives one operand per
+    // word, and an upper-case NEAR or NEAR/n between two operands links them
+    struct Token {
+        std::vector<std::string> words;
+        bool is_near = false;
+        uint32_t window = 0;
+    };
+    std::vector<Token> tokens;
+    auto add_bare = [&](const std::string& text) {
+        Token token;
+        if (near_operator(text, token.window)) {
+            token.is_near = true;
+            token.words = {"near"}; // searched as the word when it has no operand on one side
+            tokens.push_back(token);
+            return;
+        }
+        for (std::string& word : split_vocabulary_words(text)) tokens.push_back({{std::move(word)}});
+    };
+
+    std::string bare;
+    for (size_t pos = 0; pos < query.size(); ++pos) {
+        char c = query[pos];
+        if (c == '"') {
+            add_bare(bare);
+            bare.clear();
+            size_t close = query.find('"', pos + 1);
+            if (close == std::string::npos) close = query.size();
+            std::vector<std::string> words = split_vocabulary_words(query.substr(pos + 1, close - pos - 1));
+            if (!words.empty()) tokens.push_back({std::move(words)});
+            pos = close;
+        } else if (std::isspace(static_cast<unsigned char>(c))) {
+            add_bare(bare);
+            bare.clear();
+        } else {
+            bare += c;
+        }
+    }
+    add_bare(bare);
+
+    // An operand linked by NEAR only counts through the proximity test
+    std::vector<std::vector<uint32_t>> parts;
+    std::vector<char> linked(tokens.size(), 0);
+    for (size_t t = 0; t < tokens.size(); ++t) {
+        if (!tokens[t].is_near) continue;
+        bool operands = t > 0 && t + 1 < tokens.size() && !tokens[t - 1].is_near && !tokens[t + 1].is_near;
+        if (!operands) {
+            tokens[t].is_near = false; // a stray NEAR is just the word
+            continue;
+        }
+        parts.push_back(near(tokens[t - 1].words, tokens[t + 1].words, tokens[t].window));
+        linked[t] = linked[t - 1] = linked[t + 1] = 1;
+    }
+    for (size_t t = 0; t < tokens.size(); ++t) {
+        if (!linked[t]) parts.push_back(phrase(tokens[t].words));
+    }
+
+    if (parts.empty()) return false;
+
+    // Intersect shortest first
+    std::sort(parts.begin(), parts.end(), [](const auto& a, const auto& b) { return a.size() < b.size(); });
+    ids = parts[0];
+    std::vector<uint32_t> both;
+    for (size_t k = 1; k < parts.size() && !ids.empty(); ++k) {
+        intersect_sorted(ids, parts[k], both);
+        ids.swap(both);
+    }
+    return true;
+}
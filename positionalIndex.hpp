@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Positional inverted index over one text field (the directions). For each term it stores the
+// recipes containing it and the word positions inside each, as a byte stream of varints:
+//   doc delta, position count, position deltas...
+// Documents are added in recipe id order, so every stream only ever grows at the end.
+class PositionalIndex {
+public:
+    void clear();
+
+    // Tokenizes and indexes all texts, tokenizing in parallel; texts[i] belongs to recipe i
+    void build(const std::vector<const std::string*>& texts);
+    void add_document(uint32_t recipe_id, const std::string& text);
+
+    // Sorted ids of recipes containing every word of the phrase, consecutively and in order
+    std::vector<uint32_t> phrase(const std::vector<std::string>& words) const;
+
+    // Sorted ids of recipes where phrases a and b occur within `window` words of each other, in
+    // either order; the distance is counted between the end of one and the start of the other
+    std::vector<uint32_t> near(const std::vector<std::string>& a, const std::vector<std::string>& b,
+                               uint32_t window) const;
+
+    // Query text: "quoted phrases", bare words and `x NEAR/5 y` (or NEAR, 5 words), where x and y
+    // are the words or phrases either side; every part must match. Only the exact upper-case
+    // operator counts, so "nearly" or "near" in the text are plain words.
+    // Returns false (and no ids) if the text has no searchable part.
+    bool search(const std::string& query, std::vector<uint32_t>& ids) const;
+
+    // Recipes whose text contains the term
+    uint32_t document_frequency(const std::string& term) const;
+
+    size_t term_count() const { return streams.size(); }
+    size_t memory_bytes() const;
+
+private:
+    struct Stream {
+        std::vector<uint8_t> bytes;
+        uint32_t last_doc = 0;
+        uint32_t doc_count = 0;
+    };
+
+    // Walks one term's stream document by document
+    class Cursor {
+    public:
+        explicit Cursor(const Stream* stream) : stream(stream) {}
+        bool next();  // advances to the next document; false at the end
+        uint32_t doc = 0;
+        std::vector<uint32_t> positions;
+
+    private:
+        const Stream* stream;
+        size_t offset = 0;
+        uint32_t seen = 0;
+    };
+
+    // Start positions of a phrase in every document containing it, in document order
+    struct Occurrences {
+        uint32_t doc;
+        std::vector<uint32_t> starts;
+    };
+    std::vector<Occurrences> occurrences(const std::vector<std::string>& words) const;
+
+    const Stream* find(const std::string& term) const;
+    void append(uint32_t recipe_id, const std::vector<std::pair<std::string, std::vector<uint32_t>>>& terms);
+
+    std::unordered_map<std::string, uint32_t> term_ids;
+    std::vector<Stream> streams;
+};
@@ -0,0 +1,343 @@
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "postingList.hpp"
+
+static uint8_t bits_needed(uint32_t value) {
+    uint8_t bits = 0;
+    while (value) {
+        ++bits;
+        value >>= 1;
+    }
+    return bits;
+}
+
+CompressedPostings::CompressedPostings(const std::vector<uint32_t>& sorted_ids) {
+    for (uint32_t id : sorted_ids) push_back(id);
+}
+
+void CompressedPostings::push_back(uint32_t id) {
+    tail.push_back(id);
+    ++total;
+    if (tail.size() == kBlockSize) flush_tail();
+}
+
+// Packs the tail as one block: the first id is kept in the header, the remaining ids as
+// (delta - 1) in the smallest width that fits the largest of them
+void CompressedPostings::flush_tail() {
+    if (tail.empty()) return;
+
+    Block block;
+    block.first = tail.front();
+    block.last = tail.back();
+    block.offset = static_cast<uint32_t>(packed.size());
+    block.count = static_cast<uint16_t>(tail.size());
+
+    uint32_t max_gap = 0;
+    for (size_t i = 1; i < tail.size(); ++i) max_gap = std::max(max_gap, tail[i] - tail[i - 1] - 1);
+    block.width = bits_needed(max_gap);
+
+    size_t bit_count = (tail.size() - 1) * block.width;
+    packed.resize(packed.size() + (bit_count + 31) / 32, 0);
+    uint32_t* words = packed.data() + block.offset;
+    size_t bit = 0;
+    for (size_t i = 1; i < tail.size(); ++i, bit += block.width) {
+        if (block.width == 0) break;
+        uint64_t gap = tail[i] - tail[i - 1] - 1;
+        words[bit / 32] |= static_cast<uint32_t>(gap << (bit % 32));
+        if (bit % 32 + block.width > 32) words[bit / 32 + 1] |= static_cast<uint32_t>(gap >> (32 - bit % 32));
+    }
+
+    blocks.push_back(block);
+    tail.clear();
+}
+
+void CompressedPostings::decode_block(const Block& block, uint32_t* out) const {
+    const uint32_t* words = packed.data() + block.offset;
+    const uint32_t mask = block.width == 32 ? UINT32_MAX : (uint32_t(1) << block.width) - 1;
+    uint32_t value = block.first;
+    out[0] = value;
+    size_t bit = 0;
+    for (size_t i = 1; i < block.count; ++i, bit += block.width) {
+        uint32_t gap = 0;
+        if (block.width) {
+            uint64_t window = words[bit / 32];
+            if (bit % 32 + block.width > 32) window |= uint64_t(words[bit / 32 + 1]) << 32;
+            gap = static_cast<uint32_t>(window >> (bit % 32)) & mask;
+        }
+        value += gap + 1;
+        out[i] = value;
+    }
+}
+
+size_t CompressedPostings::memory_bytes() const {
+    return blocks.size() * sizeof(Block) + packed.size() * sizeof(uint32_t) + tail.size() * sizeof(uint32_t);
+}
+
+void CompressedPostings::decode_into(std::vector<uint32_t>& out) const {
+    out.resize(total);
+    size_t pos = 0;
+    for (const Block& block : blocks) {
+        decode_block(block, out.data() + pos);
+        pos += block.count;
+    }
+    std::copy(tail.begin(), tail.end(), out.begin() + pos);
+}
+
+std::vector<uint32_t> CompressedPostings::decode() const {
+    std::vector<uint32_t> out;
+    decode_into(out);
+    return out;
+}
+
+std::vector<uint32_t> CompressedPostings::intersect(const std::vector<uint32_t>& probe) const {
+    std::vector<uint32_t> result, part;
+    uint32_t buffer[kBlockSize];
+    auto p = probe.begin();
+
+    // Intersects the probe ids up to the end of a decoded block with that block
+    auto intersect_range = [&](const uint32_t* ids, size_t count) {
+        auto stop = std::upper_bound(p, probe.end(), ids[count - 1]);
+        intersect_sorted(&*p, static_cast<size_t>(stop - p), ids, count, part);
+        result.insert(result.end(), part.begin(), part.end());
+        p = stop;
+    };
+
+    for (const Block& block : blocks) {
+        p = std::lower_bound(p, probe.end(), block.first);
+        if (p == probe.end()) return result;
+        if (*p > block.last) continue; // no probe id falls inside this block
+        decode_block(block, buffer);
+        intersect_range(buffer, block.count);
+    }
+    if (!tail.empty()) {
+        p = std::lower_bound(p, probe.end(), tail.front());
+        if (p != probe.end()) intersect_range(tail.data(), tail.size());
+    }
+    return result;
+}
+
+void intersect_merge(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, std::vector<uint32_t>& out) {
+    out.clear();
+    size_t i = 0, j = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) ++i;
+        else if (b[j] < a[i]) ++j;
+        else {
+            out.push_back(a[i]);
+            ++i;
+            ++j;
+        }
+    }
+}
+
+void intersect_galloping(const uint32_t* small, size_t ns, const uint32_t* large, size_t nl, std::vector<uint32_t>& out) {
+    out.clear();
+    size_t lo = 0;
+    for (size_t i = 0; i < ns && lo < nl; ++i) {
+        const uint32_t target = small[i];
+        // Double the step until the target is bracketed, then binary search the bracket
+        size_t step = 1, hi = lo;
+        while (hi < nl && large[hi] < target) {
+            lo = hi + 1;
+            hi += step;
+            step *= 2;
+        }
+        hi = std::min(hi + 1, nl);
+        lo = static_cast<size_t>(std::lower_bound(large + lo, large + hi, target) - large);
+        if (lo < nl && large[lo] == target) out.push_back(target);
+    }
+}
+
+void intersect_simd(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, std::vector<uint32_t>& out) {
+#if defined(__SSE2__)
+    out.clear();
+    size_t i = 0, j = 0;
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+
+        // Compare every lane of a with every lane of b by rotating b three times
+        __m128i eq = _mm_cmpeq_epi32(va, vb);
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        for (int lane = 0; lane < 4; ++lane)
+            if (mask & (1 << lane)) out.push_back(a[i + lane]);
+
+        const uint32_t a_max = a[i + 3], b_max = b[j + 3];
+        if (a_max <= b_max) i += 4;
+        if (b_max <= a_max) j += 4;
+    }
+
+    // Scalar merge over whatever is left
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) ++i;
+        else if (b[j] < a[i]) ++j;
+        else {
+            out.push_back(a[i]);
+            ++i;
+            ++j;
+        }
+    }
+#else
+    intersect_merge(a, na, b, nb, out);
+#endif
+}
+
+void intersect_sorted(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, std::vector<uint32_t>& out) {
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (na * 32 < nb)
+        intersect_galloping(a, na, b, nb, out);
+    else
+        intersect_simd(a, na, b, nb, out);
+}
+
+void intersect_sorted(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& out) {
+    intersect_sorted(a.data(), a.size(), b.data(), b.size(), out);
+}
+
+void union_merge(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, std::vector<uint32_t>& out) {
+    out.clear();
+    out.reserve(na + nb);
+    size_t i = 0, j = 0;
+    while (i < na && j < nb) {
+        uint32_t x = a[i], y = b[j];
+        out.push_back(x <= y ? x : y);
+        i += x <= y;
+        j += y <= x;
+    }
+    out.insert(out.end(), a + i, a + na);
+    out.insert(out.end(), b + j, b + nb);
+}
+
+void union_galloping(const uint32_t* small, size_t ns, const uint32_t* large, size_t nl, std::vector<uint32_t>& out) {
+    out.clear();
+    out.reserve(ns + nl);
+    size_t lo = 0;
+    for (size_t i = 0; i < ns; ++i) {
+        const uint32_t target = small[i];
+        size_t step = 1, hi = lo;
+        while (hi < nl && large[hi] < target) {
+            hi += step;
+            step *= 2;
+        }
+        size_t at = static_cast<size_t>(std::lower_bound(large + lo, large + std::min(hi + 1, nl), target) - large);
+        out.insert(out.end(), large + lo, large + at);
+        out.push_back(target);
+        lo = at < nl && large[at] == target ? at + 1 : at;
+    }
+    out.insert(out.end(), large + lo, large + nl);
+}
+
+#if defined(__SSE2__)
+// SSE2 has no unsigned 32-bit min/max: lanes are kept with the sign bit flipped so the signed
+// compare orders them, and flipped back when stored
+static inline __m128i flip_sign(__m128i v) { return _mm_xor_si128(v, _mm_set1_epi32(INT32_MIN)); }
+
+static inline void min_max(__m128i a, __m128i b, __m128i& lo, __m128i& hi) {
+    __m128i gt = _mm_cmpgt_epi32(a, b);
+    lo = _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+    hi = _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+
+// Merges two sorted vectors: the four smallest lanes end up sorted in lo, the four largest in hi.
+// Each round rotates lo by one lane and takes lane-wise min/max against hi (Inoue et al.).
+static inline void merge4(__m128i a, __m128i b, __m128i& lo, __m128i& hi) {
+    min_max(a, b, lo, hi);
+    for (int round = 0; round < 3; ++round)
+        min_max(_mm_shuffle_epi32(lo, _MM_SHUFFLE(0, 3, 2, 1)), hi, lo, hi);
+    lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(0, 3, 2, 1));
+}
+
+// Writes the lanes of v that differ from the lane before them at dst and returns the new end;
+// previous holds the lanes stored last, so a duplicate split across two stores is caught too.
+// SSE2 has no byte shuffle to compact lanes, so every lane is written and the cursor only moves
+// past the distinct ones.
+static inline uint32_t* store_distinct(__m128i v, __m128i previous, uint32_t* dst) {
+    __m128i before = _mm_or_si128(_mm_slli_si128(v, 4), _mm_srli_si128(previous, 12));
+    int repeated = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, before)));
+    alignas(16) uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), flip_sign(v));
+    for (int lane = 0; lane < 4; ++lane) {
+        *dst = lanes[lane];
+        dst += !(repeated & (1 << lane));
+    }
+    return dst;
+}
+#endif
+
+void union_simd(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, std::vector<uint32_t>& out) {
+#if defined(__SSE2__)
+    if (na < 4 || nb < 4) {
+        union_merge(a, na, b, nb, out);
+        return;
+    }
+    out.resize(na + nb);
+    uint32_t* dst = out.data();
+    auto load = [](const uint32_t* p) { return flip_sign(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); };
+
+    __m128i lo, hi;
+    merge4(load(a), load(b), lo, hi);
+    // Nothing was stored before the first vector: seed previous with the complement of its first lane
+    __m128i previous = _mm_xor_si128(_mm_shuffle_epi32(lo, 0), _mm_set1_epi32(-1));
+    dst = store_distinct(lo, previous, dst);
+    previous = lo;
+
+    // hi carries the four largest ids seen so far; the next vector comes from whichever list has
+    // the smaller head, so everything below hi's smallest lane has been stored
+    size_t i = 4, j = 4;
+    while (i + 4 <= na && j + 4 <= nb) {
+        bool take_a = a[i] <= b[j];
+        __m128i next = load(take_a ? a + i : b + j);
+        i += take_a ? 4 : 0;
+        j += take_a ? 0 : 4;
+        merge4(next, hi, lo, hi);
+        dst = store_distinct(lo, previous, dst);
+        previous = lo;
+    }
+
+    // Scalar three-way merge of the pending lanes and both list tails
+    alignas(16) uint32_t pending[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(pending), flip_sign(hi));
+    size_t k = 0;
+    auto append = [&](uint32_t id) {
+        *dst = id;
+        dst += dst == out.data() || dst[-1] != id;
+    };
+    while (k < 4 || i < na || j < nb) {
+        uint32_t x = k < 4 ? pending[k] : UINT32_MAX;
+        uint32_t y = i < na ? a[i] : UINT32_MAX;
+        uint32_t z = j < nb ? b[j] : UINT32_MAX;
+        if (k < 4 && x <= y && x <= z) {
+            append(x);
+            ++k;
+        } else if (i < na && (j >= nb || y <= z)) {
+            append(y);
+            ++i;
+        } else {
+            append(z);
+            ++j;
+        }
+    }
+    out.resize(static_cast<size_t>(dst - out.data()));
+#else
+    union_merge(a, na, b, nb, out);
+#endif
+}
+
+void union_sorted(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& out) {
+    const std::vector<uint32_t>& small = a.size() <= b.size() ? a : b;
+    const std::vector<uint32_t>& large = a.size() <= b.size() ? b : a;
+    if (small.size() * 32 < large.size())
+        union_galloping(small.data(), small.size(), large.data(), large.size(), out);
+    else
+        union_merge(a.data(), a.size(), b.data(), b.size(), out);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Sorted list of recipe ids stored as blocks of 128 delta-encoded, bit-packed values.
+// Each block keeps its first and last id, so intersections can skip blocks without decoding
+// them. New ids are appended to an uncompressed tail that is packed once it fills a block.
+class CompressedPostings {
+public:
+    static constexpr size_t kBlockSize = 128;
+
+    CompressedPostings() = default;
+    explicit CompressedPostings(const std::vector<uint32_t>& sorted_ids);
+
+    // id must be larger than every id already in the list
+    void push_back(uint32_t id);
+
+    size_t size() const { return total; }
+    bool empty() const { return total == 0; }
+    size_t memory_bytes() const;
+
+    std::vector<uint32_t> decode() const;
+    void decode_into(std::vector<uint32_t>& out) const;
+
+    // Ids of the sorted probe list that are also in this list
+    std::vector<uint32_t> intersect(const std::vector<uint32_t>& probe) const;
+
+private:
+    struct Block {
+        uint32_t first;
+        uint32_t last;
+        uint32_t offset;  // first word of the block in packed
+        uint16_t count;
+        uint8_t width;    // bits per packed delta
+    };
+
+    void flush_tail();
+    void decode_block(const Block& block, uint32_t* out) const;
+
+    std::vector<Block> blocks;
+    std::vector<uint32_t> packed;
+    std::vector<uint32_t> tail;
+    size_t total = 0;
+};
+
+// Kernels over plain sorted id arrays. out is cleared first.
+
+// Linear merge
+void intersect_merge(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, std::vector<uint32_t>& out);
+
+// Exponential search of each element of the short list in the long one
+void intersect_galloping(const uint32_t* small, size_t ns, const uint32_t* large, size_t nl, std::vector<uint32_t>& out);
+
+// 4x4 all-pairs comparison with SSE2, falling back to intersect_merge on other targets
+void intersect_simd(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, std::vector<uint32_t>& out);
+
+// Picks galloping for lopsided inputs and the SIMD kernel otherwise
+void intersect_sorted(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, std::vector<uint32_t>& out);
+void intersect_sorted(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& out);
+
+// Unions of two sorted id sets (no repeats within a list)
+
+// Branch-light scalar merge
+void union_merge(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, std::vector<uint32_t>& out);
+
+// Exponential search for where each element of the short list goes; the long list is copied in runs
+void union_galloping(const uint32_t* small, size_t ns, const uint32_t* large, size_t nl, std::vector<uint32_t>& out);
+
+// SSE2 merge network over 4-id vectors with duplicates dropped on store, falling back to
+// union_merge on other targets. Without SSE4.1's unsigned min/max and byte shuffles it measures
+// slower than union_merge (make bench-postings), so union_sorted does not pick it.
+void union_simd(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, std::vector<uint32_t>& out);
+
+// Picks galloping for lopsided inputs and the scalar merge otherwise
+void union_sorted(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& out);
@@ -0,0 +1,589 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+
+#include "queryLanguage.hpp"
+#include "caseFold.hpp"
+#include "data.hpp"
+#include "ingredientDictionary.hpp"
+#include "searchIndex.hpp"
+#include "symSpell.hpp"
+
+// Lexer
+
+namespace {
+
+struct Token {
+    enum class Type { Word, Quoted, LParen, RParen, Op, End };
+    Type type;
+    std::string text;
+};
+
+bool is_operator_char(char c) { return c == '<' || c == '>' || c == '='; }
+
+std::vector<Token> tokenize_query(const std::string& text) {
+    std::vector<Token> tokens;
+    size_t i = 0;
+    while (i < text.size()) {
+        char c = text[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+        } else if (c == '(' || c == ')') {
+            tokens.push_back({c == '(' ? Token::Type::LParen : Token::Type::RParen, std::string(1, c)});
+            ++i;
+        } else if (c == '"') {
+            size_t close = text.find('"', i + 1);
+            if (close == std::string::npos) close = text.size();
+            tokens.push_back({Token::Type::Quoted, text.substr(i + 1, close - i - 1)});
+            i = close + 1;
+        } else if (is_operator_char(c)) {
+            size_t start = i;
+            while (i < text.size() && is_operator_char(text[i])) ++i;
+            tokens.push_back({Token::Type::Op, text.substr(start, i - start)});
+        } else {
+            size_t start = i;
+            while (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i])) && text[i] != '(' &&
+                   text[i] != ')' && text[i] != '"' && !is_operator_char(text[i])) {
+                ++i;
+                if (text[i - 1] == ':') break; // "name:" ends the word so a quote may follow
+            }
+            tokens.push_back({Token::Type::Word, text.substr(start, i - start)});
+        }
+    }
+    tokens.push_back({Token::Type::End, ""});
+    return tokens;
+}
+
+std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+bool is_duration_field(const std::string& field) {
+    return field == "time" || field == "total" || field == "prep" || field == "cook";
+}
+
+bool is_numeric_field(const std::string& field) {
+    Nutrient nutrient;
+    return is_duration_field(field) || field == "rating" || find_nutrient(field, nutrient);
+}
+
+bool is_duration_unit(const std::string& word) {
+    static const char* units[] = {"h", "hr", "hrs", "hour", "hours", "m", "min", "mins", "minute", "minutes",
+                                  "d", "day", "days"};
+    std::string w = lower(word);
+    return std::find_if(std::begin(units), std::end(units), [&](const char* u) { return w == u; }) != std::end(units);
+}
+
+// Parser: recursive descent over
+//   or  := and (OR and)*
+//   and := unary ((AND)? unary)*
+//   unary := NOT unary | '(' or ')' | field op value | [field:] word-or-quoted
+
+class Parser {
+public:
+    explicit Parser(std::vector<Token> tokens) : tokens(std::move(tokens)) {}
+
+    std::unique_ptr<QueryNode> parse(std::string& error) {
+        auto node = parse_or();
+        if (node && peek().type != Token::Type::End) fail("unexpected '" + peek().text + "'");
+        if (!message.empty()) {
+            error = message;
+            return nullptr;
+        }
+        return node;
+    }
+
+private:
+    const Token& peek() const { return tokens[pos]; }
+    Token take() { return tokens[pos < tokens.size() - 1 ? pos++ : pos]; }
+    bool keyword(const char* word) const { return peek().type == Token::Type::Word && lower(peek().text) == word; }
+    void fail(const std::string& why) { if (message.empty()) message = why; }
+
+    static std::unique_ptr<QueryNode> combine(QueryNode::Kind kind, std::unique_ptr<QueryNode> left,
+                                              std::unique_ptr<QueryNode> right) {
+        if (left->kind == kind) {
+            left->children.push_back(std::move(right));
+            return left;
+        }
+        auto node = std::make_unique<QueryNode>();
+        node->kind = kind;
+        node->children.push_back(std::move(left));
+        node->children.push_back(std::move(right));
+        return node;
+    }
+
+    std::unique_ptr<QueryNode> parse_or() {
+        auto left = parse_and();
+        while (left && keyword("or")) {
+            take();
+            auto right = parse_and();
+            if (!right) return nullptr;
+            left = combine(QueryNode::Kind::Or, std::move(left), std::move(right));
+        }
+        return left;
+    }
+
+    bool starts_unary() const {
+        const Token& t = peek();
+        if (t.type == Token::Type::End || t.type == Token::Type::RParen || t.type == Token::Type::Op) return false;
+        return !keyword("or");
+    }
+
+    std::unique_ptr<QueryNode> parse_and() {
+        auto left = parse_unary();
+        while (left) {
+            if (keyword("and")) take();
+            else if (!starts_unary()) break;
+            auto right = parse_unary();
+            if (!right) return nullptr;
+            left = combine(QueryNode::Kind::And, std::move(left), std::move(right));
+        }
+        return left;
+    }
+
+    std::unique_ptr<QueryNode> parse_unary() {
+        if (keyword("not")) {
+            take();
+            auto inner = parse_unary();
+            if (!inner) return nullptr;
+            auto node = std::make_unique<QueryNode>();
+            node->kind = QueryNode::Kind::Not;
+            node->children.push_back(std::move(inner));
+            return node;
+        }
+
+        Token t = take();
+        if (t.type == Token::Type::LParen) {
+            auto inner = parse_or();
+            if (!inner) return nullptr;
+            if (take().type != Token::Type::RParen) {
+                fail("missing ')'");
+                return nullptr;
+            }
+            return inner;
+        }
+        if (t.type == Token::Type::Quoted) return make_term("any", t.text, true);
+        if (t.type != Token::Type::Word) {
+            fail(t.type == Token::Type::End ? "query ends early" : "unexpected '" + t.text + "'");
+            return nullptr;
+        }
+
+        std::string word = lower(t.text);
+
+        // Numeric predicate: field op value
+        if (is_numeric_field(word) && peek().type == Token::Type::Op) {
+            auto node = std::make_unique<QueryNode>();
+            node->kind = QueryNode::Kind::Compare;
+            node->field = word == "total" ? "time" : word;
+            node->op = take().text;
+            if (node->op != "<" && node->op != "<=" && node->op != ">" && node->op != ">=" && node->op != "=") {
+                fail("unknown operator '" + node->op + "'");
+                return nullptr;
+            }
+            // Ratings and nutrients are one number ("500mg"); durations may span words ("1 hr 30 mins")
+            const bool duration = is_duration_field(node->field);
+            std::string operand;
+            while (peek().type == Token::Type::Word && !keyword("and") && !keyword("or") && !keyword("not")) {
+                bool number = std::isdigit(static_cast<unsigned char>(peek().text[0])) || peek().text[0] == '.';
+                if (!operand.empty() && (!duration || (!number && !is_duration_unit(peek().text))))
+                    break;
+                operand += take().text + " ";
+            }
+            if (!operand.empty()) operand.pop_back();
+            if (operand.empty()) {
+                fail("missing value after " + word + node->op);
+                return nullptr;
+            }
+            if (!duration) {
+                node->value = std::atof(operand.c_str());
+            } else {
+                int minutes = parse_duration_minutes(operand);
+                if (minutes < 0) {
+                    fail("cannot read '" + operand + "' as a time");
+                    return nullptr;
+                }
+                node->value = minutes;
+            }
+            return node;
+        }
+
+        // Field prefix: "name:soup", "ingredient:\"brown sugar\""
+        size_t colon = word.find(':');
+        if (colon != std::string::npos) {
+            std::string field = word.substr(0, colon);
+            if (field == "ing") field = "ingredient";
+            if (field == "dir") field = "directions";
+            if (field != "name" && field != "ingredient" && field != "directions") {
+                fail("unknown field '" + field + "'");
+                return nullptr;
+            }
+            std::string rest = t.text.substr(colon + 1);
+            if (!rest.empty()) return make_term(field, rest, false);
+            Token value = take();
+            if (value.type != Token::Type::Word && value.type != Token::Type::Quoted) {
+                fail("missing text after " + field + ":");
+                return nullptr;
+            }
+            return make_term(field, value.text, value.type == Token::Type::Quoted);
+        }
+
+        return make_term("any", t.text, false);
+    }
+
+    static std::unique_ptr<QueryNode> make_term(const std::string& field, const std::string& text, bool quoted) {
+        auto node = std::make_unique<QueryNode>();
+        node->kind = QueryNode::Kind::Term;
+        node->field = field;
+        node->text = text;
+        node->quoted = quoted;
+        return node;
+    }
+
+    std::vector<Token> tokens;
+    size_t pos = 0;
+    std::string message;
+};
+
+} // namespace
+
+std::unique_ptr<QueryNode> parse_query(const std::string& text, std::string& error) {
+    error.clear();
+    return Parser(tokenize_query(text)).parse(error);
+}
+
+// Plan
+
+struct QueryPlan::Operator {
+    enum class Kind { Intersect, Union, Complement, All, Name, Ingredient, Directions, Range };
+
+    Kind kind = Kind::All;
+    std::string label;
+
+    // Leaves
+    std::string text;                      // lowered name text, ingredient text or directions query
+    std::vector<uint32_t> ingredient_ids;  // resolved canonical ids; empty means substring matching
+    const NumericColumn* column = nullptr; // Range
+    double lo = 0.0, hi = 0.0;
+    double (*value_of)(const Recipe&) = nullptr;
+    int scan_column = -1;                  // NutritionColumns column when the range is on a nutrient
+    bool as_filter = false;                // Range applied per recipe to the running candidates
+
+    // Inner nodes. Intersect keeps its inputs in execution order and its NOT inputs in excluded.
+    std::vector<std::unique_ptr<Operator>> children;
+    std::vector<std::unique_ptr<Operator>> excluded;
+
+    size_t estimate = 0;
+    size_t rows = 0;
+    double millis = 0.0;
+};
+
+namespace {
+
+using OperatorPtr = std::unique_ptr<QueryPlan::Operator>;
+
+double total_of(const Recipe& r) { return r.total_minutes; }
+double prep_of(const Recipe& r) { return r.prep_minutes; }
+double cook_of(const Recipe& r) { return r.cook_minutes; }
+double rating_of(const Recipe& r) { return r.rating; }
+
+std::string format_number(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%g", value);
+    return buffer;
+}
+
+} // namespace
+
+static ColumnPredicate scan_predicate(const QueryPlan::Operator& op) {
+    return {static_cast<uint32_t>(op.scan_column), static_cast<float>(op.lo), static_cast<float>(op.hi)};
+}
+
+// Builds the physical operator for one AST node, with a row estimate from index statistics
+static OperatorPtr compile(const QueryNode& node);
+
+static OperatorPtr make_operator(QueryPlan::Operator::Kind kind, std::string label) {
+    auto op = std::make_unique<QueryPlan::Operator>();
+    op->kind = kind;
+    op->label = std::move(label);
+    return op;
+}
+
+static OperatorPtr compile_term(const QueryNode& node) {
+    using Kind = QueryPlan::Operator::Kind;
+    const std::string shown = node.field + ":\"" + node.text + "\"";
+
+    if (node.field == "name") {
+        auto op = make_operator(Kind::Name, "NameSubstring " + shown);
+        op->text = fold_case(node.text);
+        op->estimate = searchIndex.estimate_name_substring(op->text);
+        return op;
+    }
+    if (node.field == "ingredient") {
+        std::string text = search_key(node.text);
+        bool resolved = !canonicalize_ingredient_text(text).empty();
+        auto op = make_operator(Kind::Ingredient, (resolved ? "IngredientPostings " : "IngredientScan ") + shown);
+        op->text = text;
+        if (resolved) op->ingredient_ids = match_ingredient_ids(text);
+        if (op->ingredient_ids.empty()) {
+            op->estimate = recipes.size();
+        } else {
+            for (uint32_t id : op->ingredient_ids) op->estimate += searchIndex.ingredient_postings[id].size();
+            op->estimate = std::min(op->estimate, recipes.size());
+        }
+        return op;
+    }
+    if (node.field == "directions") {
+        auto op = make_operator(Kind::Directions, "DirectionsPositions " + shown);
+        std::vector<std::string> words = split_vocabulary_words(node.text);
+        op->text = node.quoted && words.size() > 1 ? "\"" + node.text + "\"" : node.text;
+        op->estimate = words.empty() ? 0 : recipes.size();
+        for (const std::string& word : words)
+            op->estimate = std::min<size_t>(op->estimate, searchIndex.directions.document_frequency(word));
+        return op;
+    }
+
+    // A bare term matches the dish name or an ingredient
+    QueryNode name, ingredient;
+    name.text = ingredient.text = node.text;
+    name.quoted = ingredient.quoted = node.quoted;
+    name.field = "name";
+    ingredient.field = "ingredient";
+    auto op = make_operator(Kind::Union, "Union " + shown);
+    op->children.push_back(compile_term(name));
+    op->children.push_back(compile_term(ingredient));
+    op->estimate = std::min(op->children[0]->estimate + op->children[1]->estimate, recipes.size());
+    return op;
+}
+
+static OperatorPtr compile_compare(const QueryNode& node) {
+    auto op = make_operator(QueryPlan::Operator::Kind::Range, "Range " + node.field + node.op + format_number(node.value));
+
+    // Nutrients live in float columns answered by a SIMD scan, which also gives the exact count
+    Nutrient nutrient;
+    if (find_nutrient(node.field, nutrient)) {
+        const float value = static_cast<float>(node.value);
+        const float unbounded = std::numeric_limits<float>::infinity();
+        op->scan_column = static_cast<int>(nutrient);
+        op->lo = node.op == ">" ? std::nextafter(value, unbounded) : node.op == ">=" || node.op == "=" ? value : -unbounded;
+        op->hi = node.op == "<" ? std::nextafter(value, -unbounded) : node.op == "<=" || node.op == "=" ? value : unbounded;
+        op->estimate = searchIndex.nutrition.count_matching(scan_predicate(*op));
+        return op;
+    }
+
+    if (node.field == "prep") {
+        op->column = &searchIndex.prep_minutes;
+        op->value_of = prep_of;
+    } else if (node.field == "cook") {
+        op->column = &searchIndex.cook_minutes;
+        op->value_of = cook_of;
+    } else if (node.field == "rating") {
+        op->column = &searchIndex.rating;
+        op->value_of = rating_of;
+    } else {
+        op->column = &searchIndex.total_minutes;
+        op->value_of = total_of;
+    }
+
+    // Strict bounds step past the value; times are whole minutes and ratings have two decimals
+    const double step = node.field == "rating" ? 0.005 : 0.5;
+    op->lo = node.op == ">" ? node.value + step : node.op == ">=" || node.op == "=" ? node.value : -1e300;
+    op->hi = node.op == "<" ? node.value - step : node.op == "<=" || node.op == "=" ? node.value : 1e300;
+    op->estimate = op->column->count_in_range(op->lo, op->hi);
+    return op;
+}
+
+static OperatorPtr compile_and(const QueryNode& node) {
+    using Kind = QueryPlan::Operator::Kind;
+    auto op = make_operator(Kind::Intersect, "Intersect");
+
+    std::vector<OperatorPtr> terms, ranges;
+    for (const auto& child : node.children) {
+        if (child->kind == QueryNode::Kind::Not) {
+            op->excluded.push_back(compile(*child->children[0]));
+            continue;
+        }
+        OperatorPtr compiled = compile(*child);
+        (compiled->kind == Kind::Range ? ranges : terms).push_back(std::move(compiled));
+    }
+    auto by_estimate = [](const OperatorPtr& a, const OperatorPtr& b) { return a->estimate < b->estimate; };
+    std::stable_sort(terms.begin(), terms.end(), by_estimate);
+    std::stable_sort(ranges.begin(), ranges.end(), by_estimate);
+
+    // The smallest input drives; ranges then filter its candidates directly, which is cheaper
+    // than materializing a wide range; the other inputs are intersected smallest first
+    OperatorPtr driver;
+    bool driver_is_range = !ranges.empty() && (terms.empty() || ranges[0]->estimate < terms[0]->estimate);
+    if (driver_is_range) {
+        driver = std::move(ranges[0]);
+        ranges.erase(ranges.begin());
+    } else if (!terms.empty()) {
+        driver = std::move(terms[0]);
+        terms.erase(terms.begin());
+    } else {
+        driver = make_operator(Kind::All, "AllRecipes");
+        driver->estimate = recipes.size();
+    }
+
+    op->estimate = driver->estimate;
+    op->children.push_back(std::move(driver));
+    for (auto& range : ranges) {
+        range->as_filter = true;
+        range->label = "Filter" + range->label.substr(5);
+        op->children.push_back(std::move(range));
+    }
+    for (auto& term : terms) op->children.push_back(std::move(term));
+    return op;
+}
+
+static OperatorPtr compile(const QueryNode& node) {
+    using Kind = QueryPlan::Operator::Kind;
+    switch (node.kind) {
+    case QueryNode::Kind::Term:
+        return compile_term(node);
+    case QueryNode::Kind::Compare:
+        return compile_compare(node);
+    case QueryNode::Kind::And:
+        return compile_and(node);
+    case QueryNode::Kind::Or: {
+        auto op = make_operator(Kind::Union, "Union");
+        for (const auto& child : node.children) {
+            op->children.push_back(compile(*child));
+            op->estimate += op->children.back()->estimate;
+        }
+        op->estimate = std::min(op->estimate, recipes.size());
+        return op;
+    }
+    case QueryNode::Kind::Not: {
+        // A NOT outside an AND has nothing to subtract from but the whole collection
+        auto op = make_operator(Kind::Complement, "Complement");
+        op->children.push_back(compile(*node.children[0]));
+        op->estimate = recipes.size() - std::min(op->children[0]->estimate, recipes.size());
+        return op;
+    }
+    }
+    return nullptr;
+}
+
+static std::vector<uint32_t> all_recipes() {
+    std::vector<uint32_t> ids(recipes.size());
+    for (uint32_t i = 0; i < ids.size(); ++i) ids[i] = i;
+    return ids;
+}
+
+static std::vector<uint32_t> difference(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    std::vector<uint32_t> out;
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+    return out;
+}
+
+static std::vector<uint32_t> run(QueryPlan::Operator& op);
+
+static std::vector<uint32_t> run_leaf(const QueryPlan::Operator& op) {
+    using Kind = QueryPlan::Operator::Kind;
+    switch (op.kind) {
+    case Kind::Name:
+        return searchIndex.recipes_with_name_substring(op.text);
+    case Kind::Ingredient:
+        // Text without a canonical id is a SIMD scan over the packed ingredient keys
+        if (!op.ingredient_ids.empty()) return searchIndex.recipes_with_any(op.ingredient_ids);
+        return searchIndex.ingredient_keys.find(op.text);
+    case Kind::Directions: {
+        std::vector<uint32_t> ids;
+        searchIndex.directions.search(op.text, ids);
+        return ids;
+    }
+    case Kind::Range:
+        if (op.scan_column >= 0) return searchIndex.nutrition.filter({scan_predicate(op)});
+        return op.column->recipes_in_range(op.lo, op.hi);
+    default:
+        return all_recipes();
+    }
+}
+
+static std::vector<uint32_t> run(QueryPlan::Operator& op) {
+    using Kind = QueryPlan::Operator::Kind;
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<uint32_t> ids;
+    switch (op.kind) {
+    case Kind::Intersect:
+        ids = run(*op.children[0]);
+        for (size_t c = 1; c < op.children.size() && !ids.empty(); ++c) {
+            QueryPlan::Operator& child = *op.children[c];
+            if (child.as_filter) {
+                auto filter_start = std::chrono::steady_clock::now();
+                ids.erase(std::remove_if(ids.begin(), ids.end(), [&](uint32_t r) {
+                              if (child.scan_column >= 0) {
+                                  float v = searchIndex.nutrition.value(static_cast<uint32_t>(child.scan_column), r);
+                                  return !(v >= child.lo && v <= child.hi); // NaN never matches
+                              }
+                              double v = child.value_of(recipes[r]);
+                              return v < 0 || v < child.lo || v > child.hi;
+                          }), ids.end());
+                child.rows = ids.size();
+                child.millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - filter_start).count();
+                continue;
+            }
+            std::vector<uint32_t> both;
+            intersect_sorted(ids, run(child), both);
+            ids.swap(both);
+        }
+        for (auto& excluded : op.excluded) {
+            if (ids.empty()) break;
+            ids = difference(ids, run(*excluded));
+        }
+        break;
+    case Kind::Union:
+        for (auto& child : op.children) {
+            std::vector<uint32_t> merged;
+            union_sorted(ids, run(*child), merged);
+            ids.swap(merged);
+        }
+        break;
+    case Kind::Complement:
+        ids = difference(all_recipes(), run(*op.children[0]));
+        break;
+    default:
+        ids = run_leaf(op);
+        break;
+    }
+
+    op.rows = ids.size();
+    op.millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return ids;
+}
+
+static void explain_into(const QueryPlan::Operator& op, int depth, const char* prefix, std::string& out) {
+    char stats[96];
+    std::snprintf(stats, sizeof(stats), "  (est %zu, rows %zu, %.3f ms)\n", op.estimate, op.rows, op.millis);
+    out.append(static_cast<size_t>(depth) * 2, ' ');
+    out += prefix;
+    out += op.label;
+    out += stats;
+    for (const auto& child : op.children) explain_into(*child, depth + 1, "", out);
+    for (const auto& child : op.excluded) explain_into(*child, depth + 1, "Except ", out);
+}
+
+QueryPlan::QueryPlan(const std::string& text) {
+    std::unique_ptr<QueryNode> ast = parse_query(text, parse_error);
+    if (ast) root = compile(*ast);
+}
+
+QueryPlan::~QueryPlan() = default;
+
+std::vector<uint32_t> QueryPlan::execute() {
+    if (!root) return {};
+    return run(*root);
+}
+
+std::string QueryPlan::explain() const {
+    std::string out;
+    if (root) explain_into(*root, 0, "", out);
+    return out;
+}
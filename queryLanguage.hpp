@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Parsed form of an advanced query such as
+//   chicken AND (garlic OR shallot) NOT peanut time<=30 rating>=4
+// Adjacent terms are ANDed; AND, OR and NOT are case-insensitive. Terms may carry a field prefix
+// (name:, ingredient:, directions:) and quoted text; numeric predicates compare time, prep, cook,
+// rating or a nutrient (calories, protein, sodium, ... in the units of the nutrition facts)
+// with <, <=, >, >= or =.
+struct QueryNode {
+    enum class Kind { And, Or, Not, Term, Compare };
+
+    Kind kind = Kind::Term;
+    std::vector<std::unique_ptr<QueryNode>> children;
+
+    std::string field;  // Term: "any", "name", "ingredient", "directions"; Compare: numeric field
+    std::string text;   // Term text
+    bool quoted = false;
+    std::string op;     // Compare operator
+    double value = 0.0; // Compare operand (minutes for times)
+};
+
+// Returns null and sets error on a syntax error
+std::unique_ptr<QueryNode> parse_query(const std::string& text, std::string& error);
+
+// Physical plan over the search indexes, compiled from the AST. AND nodes run their most selective
+// input first, then apply numeric predicates as per-recipe filters on the running candidates,
+// then intersect the remaining inputs in order of estimated size and subtract the NOT inputs last.
+class QueryPlan {
+public:
+    explicit QueryPlan(const std::string& text);
+    ~QueryPlan();
+
+    bool valid() const { return root != nullptr; }
+    const std::string& error() const { return parse_error; }
+
+    // Sorted recipe ids; records rows and time for every operator
+    std::vector<uint32_t> execute();
+
+    // One line per operator with its estimated and actual rows and time, indented by depth
+    std::string explain() const;
+
+    struct Operator; // one node of the physical plan
+
+private:
+    std::unique_ptr<Operator> root;
+    std::string parse_error;
+};
@@ -13,22 +13,19 @@ std::string EscapeCSVField(const std::string& input) {
     return escaped;
 }
 
-void AppendRecipeToCSV(const Recipe& recipe, const std::string& filename) {
-    std::ofstream file(filename, std::ios::app);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open recipe CSV for appending.\n";
-        return;
-    }
-
-    // Build ingredient string
+// Build ingredient string
+std::string FormatIngredientsForCSV(const Recipe& recipe) {
     std::ostringstream ingStream;
     for (size_t i = 0; i < recipe.ingredients.size(); ++i) {
         const auto& ing = recipe.ingredients[i];
         ingStream << ing.quantity << " " << ing.unit << " " << ing.name;
         if (i < recipe.ingredients.size() - 1) ingStream << ", ";
     }
+    return ingStream.str();
+}
 
-    // Format directions string
+// Format directions string
+std::string FormatDirectionsForCSV(const Recipe& recipe) {
     // Remove leading numbers + period/parenthesis + spaces
     // Matches: "1. ", "23. ", "1) ", etc.
     std::regex stepNumberPattern(R"(^\s*\d+[\.\)]\s*)");
@@ -49,15 +46,23 @@ void AppendRecipeToCSV(const Recipe& recipe, const std::string& filename) {
 	outputStream << ". ";
     }
 
-    std::string cleanedDirections = outputStream.str();
+    return outputStream.str();
+}
+
+void AppendRecipeToCSV(const Recipe& recipe, const std::string& filename) {
+    std::ofstream file(filename, std::ios::app);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open recipe CSV for appending.\n";
+        return;
+    }
 
     // Initialize 15 columns (0-indexed, so column 1 = index 0)
     std::vector<std::string> columns(15, "");
 
     columns[1] = EscapeCSVField(recipe.name);            // Column 2
     columns[4] = EscapeCSVField(recipe.time + " mins");   // Column 5
-    columns[7] = EscapeCSVField(ingStream.str());        // Column 8
-    columns[8] = EscapeCSVField(cleanedDirections);      // Column 9
+    columns[7] = EscapeCSVField(FormatIngredientsForCSV(recipe)); // Column 8
+    columns[8] = EscapeCSVField(FormatDirectionsForCSV(recipe));  // Column 9
 
     // Output the full line with 14 commas (15 columns)
     for (size_t i = 0; i < columns.size(); ++i) {
@@ -156,12 +161,19 @@ void ShowRecipeCreatePage(AppState& appState) {
 	    newRecipe.ingredients = newIngredients;
 	    newRecipe.directions = directions;
 
-	    // Update app state
-	    //appState.recipes.push_back(newRecipe);
-
 	    // Save to CSV
 	    AppendRecipeToCSV(newRecipe, "recipes.csv");  // adjust path if needed
 
+	    // Add to the in-memory list and indexes in the same form a reload of the CSV row would produce.
+	    // The append takes the dataset lock exclusively, so stop the search holding it shared first
+	    Recipe stored;
+	    stored.name = newRecipe.name;
+	    stored.time = newRecipe.time + " mins";
+	    stored.ingredients = parse_ingredients(FormatIngredientsForCSV(newRecipe));
+	    stored.directions = FormatDirectionsForCSV(newRecipe);
+	    search_worker().cancel_current();
+	    append_recipe(stored);
+
 	    // Clear form fields
 	    recipeName[0] = '\0';
 	    totalTime[0] = '\0';
@@ -3,6 +3,7 @@
 
 #include "data.hpp"
 #include "appState.h"
+#include "searchWorker.hpp" // cancelled before a new recipe takes the dataset lock
 #include <sstream>
 #include <iostream>
 #include <ostream>
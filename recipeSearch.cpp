@@ -0,0 +1,440 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <regex>
+#include <unordered_map>
+
+#include "recipeSearch.hpp"
+#include "caseFold.hpp"
+#include "ingredientDictionary.hpp"
+#include "queryLanguage.hpp"
+#include "searchIndex.hpp"
+
+// Upper bound on the query variants a fuzzy filter is rewritten into
+static constexpr size_t kMaxFuzzyExpansions = 8;
+
+// Case-fold and trim helper, the form the precomputed ingredient keys are in
+static void normalize(std::string& s) {
+    s = search_key(s);
+}
+
+// Convert ASCII fractions in a typed quantity to the unicode form the cleaned ingredients use
+static std::string quantity_to_unicode(std::string quantity) {
+    static const std::unordered_map<std::string, std::string> ascii_to_unicode = {
+        {"1/4", "¼"}, {"1/2", "½"}, {"3/4", "¾"},
+        {"1/3", "⅓"}, {"2/3", "⅔"},
+        {"1/5", "⅕"}, {"2/5", "⅖"}, {"3/5", "⅗"}, {"4/5", "⅘"},
+        {"1/6", "⅙"}, {"5/6", "⅚"},
+        {"1/8", "⅛"}, {"3/8", "⅜"}, {"5/8", "⅝"}, {"7/8", "⅞"}
+    };
+    static const std::regex mixed_number_pattern(R"((\b\d+)\s+(\d/\d)\b)");
+    static const std::vector<std::pair<std::regex, std::string>> standalone_patterns = [] {
+        std::vector<std::pair<std::regex, std::string>> patterns;
+        for (const auto& [ascii_frac, unicode_frac] : ascii_to_unicode)
+            patterns.emplace_back(std::regex(R"(\b)" + ascii_frac + R"(\b)"), unicode_frac);
+        return patterns;
+    }();
+
+    // Handle "1 1/2" → "1½"
+    std::smatch match;
+    while (std::regex_search(quantity, match, mixed_number_pattern)) {
+        auto it = ascii_to_unicode.find(match[2]);
+        if (it == ascii_to_unicode.end()) break;
+        quantity = quantity.substr(0, match.position()) + match[1].str() + it->second +
+                   quantity.substr(match.position() + match.length());
+    }
+
+    // Handle standalone "1/2" → "½"
+    for (const auto& [pattern, unicode_frac] : standalone_patterns) {
+        quantity = std::regex_replace(quantity, pattern, unicode_frac);
+    }
+    return quantity;
+}
+
+bool parse_time_filter(const std::string& text, TimeFilter& filter) {
+    std::string s = text;
+    normalize(s);
+    if (s.empty()) return false;
+
+    filter = TimeFilter();
+    for (const auto& [prefix, field] : {std::make_pair("prep", TimeFilter::Field::Prep),
+                                        std::make_pair("cook", TimeFilter::Field::Cook),
+                                        std::make_pair("total", TimeFilter::Field::Total)}) {
+        if (s.rfind(prefix, 0) == 0) {
+            filter.field = field;
+            s = s.substr(std::strlen(prefix));
+            if (!s.empty() && s[0] == ':') s = s.substr(1);
+            normalize(s);
+            break;
+        }
+    }
+
+    // Leading comparison operator
+    std::string op;
+    while (!s.empty() && (s[0] == '<' || s[0] == '>' || s[0] == '=')) {
+        op += s[0];
+        s.erase(0, 1);
+    }
+    normalize(s);
+
+    // "15-45" and "15 to 45" ranges
+    size_t dash = s.find('-');
+    size_t to = s.find(" to ");
+    if (op.empty() && (dash != std::string::npos || to != std::string::npos)) {
+        size_t split = dash != std::string::npos ? dash : to;
+        std::string left = s.substr(0, split);
+        std::string right = s.substr(split + (dash != std::string::npos ? 1 : 4));
+        // A bare number on the left takes the right side's unit: "1-2 hrs" is 60 to 120 minutes
+        auto is_alpha = [](unsigned char c) { return std::isalpha(c) != 0; };
+        size_t unit = std::find_if(right.begin(), right.end(), is_alpha) - right.begin();
+        if (unit < right.size() && std::none_of(left.begin(), left.end(), is_alpha)) {
+            size_t unit_end = std::find_if_not(right.begin() + unit, right.end(), is_alpha) - right.begin();
+            left += " " + right.substr(unit, unit_end - unit);
+        }
+        int lo = parse_duration_minutes(left);
+        int hi = parse_duration_minutes(right);
+        if (lo < 0 || hi < 0) return false;
+        filter.min_minutes = std::min(lo, hi);
+        filter.max_minutes = std::max(lo, hi);
+        return true;
+    }
+
+    int minutes = parse_duration_minutes(s);
+    if (minutes < 0) return false;
+    const double unbounded = std::numeric_limits<double>::max();
+    if (op.empty() || op == "<=" || op == "=<") { filter.min_minutes = 0; filter.max_minutes = minutes; }
+    else if (op == "<") { filter.min_minutes = 0; filter.max_minutes = minutes - 1; }
+    else if (op == ">=" || op == "=>") { filter.min_minutes = minutes; filter.max_minutes = unbounded; }
+    else if (op == ">") { filter.min_minutes = minutes + 1; filter.max_minutes = unbounded; }
+    else if (op == "=" || op == "==") { filter.min_minutes = minutes; filter.max_minutes = minutes; }
+    else return false;
+    return true;
+}
+
+bool parse_value_range(const std::string& text, float& lo, float& hi) {
+    std::string s = text;
+    normalize(s);
+    std::string op;
+    while (!s.empty() && (s[0] == '<' || s[0] == '>' || s[0] == '=')) {
+        op += s[0];
+        s.erase(0, 1);
+    }
+    normalize(s);
+    if (s.empty() || !(std::isdigit(static_cast<unsigned char>(s[0])) || s[0] == '.')) return false;
+
+    char* end = nullptr;
+    const float value = std::strtof(s.c_str(), &end);
+    const float unbounded = std::numeric_limits<float>::infinity();
+
+    // "10-30" and "10 to 30"
+    std::string rest = end;
+    normalize(rest);
+    size_t skip = rest.rfind("to ", 0) == 0 ? 3 : 0;
+    if (op.empty() && (rest[0] == '-' || skip)) {
+        if (!skip) skip = 1;
+        float other = std::strtof(rest.c_str() + skip, &end);
+        if (end == rest.c_str() + skip) return false;
+        lo = std::min(value, other);
+        hi = std::max(value, other);
+        return true;
+    }
+
+    if (op.empty() || op == "<=" || op == "=<") { lo = -unbounded; hi = value; }
+    else if (op == "<") { lo = -unbounded; hi = std::nextafter(value, -unbounded); }
+    else if (op == ">=" || op == "=>") { lo = value; hi = unbounded; }
+    else if (op == ">") { lo = std::nextafter(value, unbounded); hi = unbounded; }
+    else if (op == "=" || op == "==") { lo = value; hi = value; }
+    else return false;
+    return true;
+}
+
+// Fuzzy variants of a filter text, or just the text itself
+static std::vector<std::string> filter_terms(const SymSpell& vocabulary, const std::string& text, bool fuzzy) {
+    if (!fuzzy || text.empty()) return {text};
+    return expand_fuzzy_query(vocabulary, text, kMaxFuzzyExpansions);
+}
+
+// Every filter of the search window, in display order before any relevance ranking
+static std::vector<SearchResult> filter_recipes(const SearchQuery& query, const std::atomic<bool>* cancelled,
+                                                std::string* explain) {
+    auto stopped = [cancelled] { return cancelled && cancelled->load(std::memory_order_relaxed); };
+
+    const std::string currentText = fold_case(query.dish_name);
+
+    std::string filterIngredient = query.ingredient;
+    std::string filterQuantity = query.quantity;
+    std::string filterUnit = query.unit;
+    normalize(filterIngredient);
+    normalize(filterQuantity);
+    normalize(filterUnit);
+    filterQuantity = quantity_to_unicode(filterQuantity);
+
+    const bool include_less_equal = query.include_less_equal;
+    const bool anyUnit = filterUnit == " " || filterUnit.empty();
+    double targetQty = filterQuantity.empty() ? -1.0 : parse_mixed_fraction(filterQuantity);
+
+    // In fuzzy mode each text filter also tries spelling corrections from the index vocabularies
+    const std::vector<std::string> ingredientTerms = filter_terms(searchIndex.ingredient_terms, filterIngredient, query.fuzzy);
+    const std::vector<std::string> nameTerms = filter_terms(searchIndex.name_terms, currentText, query.fuzzy);
+
+    // Resolve the ingredient filter to canonical ids. Queries that canonicalize to nothing
+    // (e.g. "melted") fall back to substring matching over every recipe.
+    const bool filterUsesIds = !filterIngredient.empty() &&
+        std::any_of(ingredientTerms.begin(), ingredientTerms.end(),
+                    [](const std::string& term) { return !canonicalize_ingredient_text(term).empty(); });
+    std::vector<char> filterIdMask;
+    std::vector<uint32_t> candidates;
+    if (filterUsesIds) {
+        std::vector<uint32_t> ids;
+        for (const std::string& term : ingredientTerms) {
+            std::vector<uint32_t> termIds = match_ingredient_ids(term);
+            ids.insert(ids.end(), termIds.begin(), termIds.end());
+        }
+        filterIdMask.assign(ingredientDictionary.size(), 0);
+        for (uint32_t id : ids) filterIdMask[id] = 1;
+        // Only recipes in the posting lists of the matching ids can pass the ingredient filter
+        candidates = searchIndex.recipes_with_any(ids);
+    }
+
+    // The dish name filter is answered by the name n-gram index
+    std::vector<uint32_t> nameMatches;
+    for (const std::string& term : nameTerms) {
+        std::vector<uint32_t> termMatches = searchIndex.recipes_with_name_substring(term);
+        std::vector<uint32_t> merged;
+        union_sorted(nameMatches, termMatches, merged);
+        nameMatches.swap(merged);
+    }
+    if (filterUsesIds) {
+        std::vector<uint32_t> both;
+        intersect_sorted(candidates, nameMatches, both);
+        candidates.swap(both);
+    } else {
+        candidates.swap(nameMatches);
+    }
+
+    // Ingredient text that resolves to no canonical id (e.g. "melted") is a SIMD scan over the
+    // packed ingredient keys
+    if (!filterIngredient.empty() && !filterUsesIds) {
+        std::vector<uint32_t> inKeys, merged;
+        for (const std::string& term : ingredientTerms) {
+            union_sorted(inKeys, searchIndex.ingredient_keys.find(term), merged);
+            inKeys.swap(merged);
+        }
+        std::vector<uint32_t> both;
+        intersect_sorted(candidates, inKeys, both);
+        candidates.swap(both);
+    }
+
+    // The time filter is a range lookup on the matching time column; unparsable text filters nothing
+    TimeFilter timeFilter;
+    if (parse_time_filter(query.time, timeFilter)) {
+        const NumericColumn& column = timeFilter.field == TimeFilter::Field::Prep ? searchIndex.prep_minutes
+                                    : timeFilter.field == TimeFilter::Field::Cook ? searchIndex.cook_minutes
+                                    : searchIndex.total_minutes;
+        std::vector<uint32_t> inRange = column.recipes_in_range(timeFilter.min_minutes, timeFilter.max_minutes);
+        std::vector<uint32_t> both;
+        intersect_sorted(candidates, inRange, both);
+        candidates.swap(both);
+    }
+
+    // Directions text is answered by the positional index
+    std::vector<uint32_t> inDirections;
+    if (searchIndex.directions.search(query.directions, inDirections)) {
+        std::vector<uint32_t> both;
+        intersect_sorted(candidates, inDirections, both);
+        candidates.swap(both);
+    }
+
+    // The advanced query compiles to its own plan over the indexes; a syntax error filters nothing
+    if (!query.advanced.empty()) {
+        QueryPlan plan(query.advanced);
+        if (plan.valid()) {
+            std::vector<uint32_t> both;
+            intersect_sorted(candidates, plan.execute(), both);
+            candidates.swap(both);
+            if (explain) *explain = plan.explain();
+        } else if (explain) {
+            *explain = "Syntax error: " + plan.error();
+        }
+    }
+
+    // Nutrition and rating ranges are one SIMD scan over their columns; unparsable text filters nothing
+    std::vector<ColumnPredicate> columnPredicates;
+    ColumnPredicate predicate;
+    for (uint32_t n = 0; n < kNutrientCount; ++n) {
+        if (parse_value_range(query.nutrition[n], predicate.lo, predicate.hi)) {
+            predicate.column = n;
+            columnPredicates.push_back(predicate);
+        }
+    }
+    if (parse_value_range(query.rating, predicate.lo, predicate.hi)) {
+        predicate.column = NutritionColumns::kRatingColumn;
+        columnPredicates.push_back(predicate);
+    }
+    if (!columnPredicates.empty()) {
+        std::vector<uint32_t> both;
+        intersect_sorted(candidates, searchIndex.nutrition.filter(columnPredicates), both);
+        candidates.swap(both);
+    }
+
+    // Allergen and diet exclusions test the recipe's precomputed category mask
+    if (query.excluded_categories != 0) {
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](uint32_t r) {
+                             return (searchIndex.recipe_categories[r] & query.excluded_categories) != 0;
+                         }), candidates.end());
+    }
+
+    auto ingredientMatches = [&](const Ingredient& ing) {
+        if (filterIngredient.empty()) return true;
+        if (!filterUsesIds) {
+            return std::any_of(ingredientTerms.begin(), ingredientTerms.end(),
+                               [&](const std::string& term) { return ing.name_key.find(term) != std::string::npos; });
+        }
+        if (ing.canonical_id != kNoIngredientId && filterIdMask[ing.canonical_id]) return true;
+        for (uint32_t tag : ing.tags)
+            if (filterIdMask[tag]) return true;
+        return false;
+    };
+
+    std::vector<SearchResult> results;
+    std::vector<std::pair<uint32_t, double>> sortedMatches;
+
+    // Lesser-quantity mode on a resolved ingredient is answered by the quantity index: each id's
+    // lines are already ordered by amount, so only the slice under the target is visited
+    if (stopped()) return results;
+    if (include_less_equal && filterUsesIds) {
+        if (targetQty < 0) return results;
+
+        std::vector<uint32_t> ids;
+        for (uint32_t id = 0; id < filterIdMask.size(); ++id)
+            if (filterIdMask[id]) ids.push_back(id);
+
+        std::vector<char> unitAllowed;
+        if (!anyUnit) {
+            unitAllowed.assign(searchIndex.quantity_units.size(), 0);
+            for (size_t u = 0; u < unitAllowed.size(); ++u)
+                unitAllowed[u] = searchIndex.quantity_units[u].find(filterUnit) != std::string::npos;
+        }
+        std::vector<char> recipeAllowed(recipes.size(), 0);
+        for (uint32_t r : candidates) recipeAllowed[r] = 1;
+
+        for (uint32_t r : searchIndex.recipes_with_at_most(ids, targetQty, unitAllowed, recipeAllowed))
+            results.push_back({r});
+        return results;
+    }
+
+    // The key scan has already matched unresolved ingredient text, so only the quantity, unit and
+    // lesser-quantity checks need the line-by-line pass
+    const bool keysDecideIngredient = filterIngredient.empty() || (!filterUsesIds && !include_less_equal);
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        const uint32_t i = candidates[c];
+        if (c % 64 == 0 && stopped()) return results;
+        if (keysDecideIngredient && filterQuantity.empty() && anyUnit) {
+            results.push_back({i});
+            continue;
+        }
+
+        bool matchFound = false;
+        double bestQty = -1.0;
+
+        // Compares against the keys computed at load, so the scan allocates nothing per line
+        for (const auto& ing : recipes[i].ingredients) {
+            const double ingQty = ing.amount;
+
+            bool matchIngredient = ingredientMatches(ing);
+            bool matchUnit = anyUnit || ing.unit_key.find(filterUnit) != std::string::npos;
+
+            if (include_less_equal) {
+                if (matchIngredient && matchUnit && targetQty >= 0 && ingQty <= targetQty) {
+                    matchFound = true;
+                    bestQty = std::max(bestQty, ingQty); // track best match for sort
+                }
+            } else {
+                bool matchQuantity = filterQuantity.empty() || ing.quantity_key.find(filterQuantity) != std::string::npos;
+                if (matchIngredient && matchQuantity && matchUnit) {
+                    matchFound = true;
+                    bestQty = ingQty;
+                }
+            }
+        }
+
+        if (matchFound) {
+            if (include_less_equal)
+                sortedMatches.emplace_back(i, bestQty);
+            else
+                results.push_back({i});
+        }
+    }
+
+    // If in inequality mode, sort by matched quantity descending
+    if (include_less_equal) {
+        std::stable_sort(sortedMatches.begin(), sortedMatches.end(),
+                         [](const auto& a, const auto& b) { return a.second > b.second; });
+        for (const auto& entry : sortedMatches) {
+            results.push_back({entry.first});
+        }
+    }
+
+    return results;
+}
+
+std::vector<SearchResult> run_search(const SearchQuery& query, const std::atomic<bool>* cancelled,
+                                     std::string* explain, std::vector<uint32_t>* facet_counts) {
+    std::vector<SearchResult> results = filter_recipes(query, cancelled, explain);
+    auto stopped = [cancelled] { return cancelled && cancelled->load(std::memory_order_relaxed); };
+    if (stopped()) return results;
+
+    // Facet counts are one AND-and-popcount per category node; the selected node then narrows
+    if (facet_counts) {
+        std::vector<uint32_t> ids;
+        ids.reserve(results.size());
+        for (const SearchResult& r : results) ids.push_back(r.recipe_id);
+        *facet_counts = searchIndex.cuisines.counts(ids);
+    }
+    if (query.facet != FacetTree::kRoot) {
+        results.erase(std::remove_if(results.begin(), results.end(), [&](const SearchResult& r) {
+                          return !searchIndex.cuisines.contains(query.facet, r.recipe_id);
+                      }), results.end());
+    }
+
+    // Approximate k-NN over the TF-IDF vectors, restricted to what the other filters kept
+    if (!query.similar_to.empty()) {
+        std::vector<char> allowed(recipes.size(), 0);
+        for (const SearchResult& r : results) allowed[r.recipe_id] = 1;
+        std::vector<SearchResult> nearest;
+        for (const VectorMatch& match : searchIndex.vectors.nearest(query.similar_to, kRelevanceTopK, allowed, cancelled))
+            nearest.push_back({match.recipe_id, match.similarity});
+        return nearest;
+    }
+
+    if (!query.rank_by_relevance || results.empty() || stopped()) return results;
+
+    // Query terms are the words of the dish and ingredient boxes, fuzzy variants included
+    std::vector<std::string> terms;
+    for (const std::string& variant : filter_terms(searchIndex.name_terms, fold_case(query.dish_name), query.fuzzy)) {
+        for (std::string& word : split_vocabulary_words(variant)) terms.push_back(std::move(word));
+    }
+    for (const std::string& variant : filter_terms(searchIndex.ingredient_terms, search_key(query.ingredient), query.fuzzy)) {
+        for (std::string& word : split_vocabulary_words(variant)) terms.push_back(std::move(word));
+    }
+    if (terms.empty()) return results;
+
+    std::vector<char> allowed(recipes.size(), 0);
+    for (const SearchResult& r : results) allowed[r.recipe_id] = 1;
+
+    std::vector<SearchResult> ranked;
+    for (const ScoredRecipe& s : searchIndex.relevance.top_k(terms, kRelevanceTopK, allowed)) {
+        ranked.push_back({s.recipe_id, s.score});
+        allowed[s.recipe_id] = 0;
+    }
+    // Every other match trails in filter order: those scored below the top K and those that share
+    // no whole word with the query (e.g. a partly typed name). Ranking never drops a match.
+    ranked.reserve(results.size());
+    for (const SearchResult& r : results) {
+        if (allowed[r.recipe_id]) ranked.push_back(r);
+    }
+    return ranked;
+}
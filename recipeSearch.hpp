@@ -0,0 +1,75 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "data.hpp"
+#include "dietTaxonomy.hpp"
+
+// Snapshot of the search window inputs
+struct SearchQuery {
+    std::string dish_name;
+    std::string ingredient;
+    std::string quantity;
+    std::string unit = " ";       // " " matches any unit
+    std::string time;
+    std::string directions;       // "quoted phrase", a NEAR/5 b, or words the directions must contain
+    std::string advanced;         // boolean query (see queryLanguage.hpp), ANDed with the other filters
+    CategoryMask excluded_categories = 0; // recipes with an ingredient in any of these are left out
+    uint32_t facet = 0;           // cuisine category node (see FacetTree); 0 is the root and keeps everything
+    std::array<std::string, kNutrientCount> nutrition; // range text per nutrient (see parse_value_range)
+    std::string rating;           // range text for the average rating
+    std::string similar_to;       // free text; the matches become its nearest recipes by TF-IDF vector
+    bool include_less_equal = false;
+    bool fuzzy = false;           // also match vocabulary words within a small edit distance
+    bool rank_by_relevance = false; // order by BM25 score of the dish and ingredient text
+
+    bool operator==(const SearchQuery& other) const {
+        return dish_name == other.dish_name && ingredient == other.ingredient &&
+               quantity == other.quantity && unit == other.unit && time == other.time &&
+               directions == other.directions && advanced == other.advanced &&
+               excluded_categories == other.excluded_categories && facet == other.facet &&
+               nutrition == other.nutrition && rating == other.rating && similar_to == other.similar_to &&
+               include_less_equal == other.include_less_equal && fuzzy == other.fuzzy &&
+               rank_by_relevance == other.rank_by_relevance;
+    }
+    bool operator!=(const SearchQuery& other) const { return !(*this == other); }
+};
+
+// Parsed form of the Recipe Time box: "<= 30", "< 1 hr", ">= 15", "15-45", "1-2 hrs", "30" (at
+// most 30), optionally prefixed with "prep" or "cook" to filter on that time instead of the total
+struct TimeFilter {
+    enum class Field { Total, Prep, Cook };
+    Field field = Field::Total;
+    double min_minutes = 0.0;
+    double max_minutes = 0.0;
+};
+
+// False when the text is empty or not a recognizable time filter
+bool parse_time_filter(const std::string& text, TimeFilter& filter);
+
+// Numeric range box: "<= 500", "> 20", "10-30", "= 5" or "30" (at most 30). A trailing unit
+// ("500mg", "20 g") is ignored. False when the text is empty or not a range.
+bool parse_value_range(const std::string& text, float& lo, float& hi);
+
+struct SearchResult {
+    uint32_t recipe_id;
+    float score = 0.0f; // BM25 score when ranking by relevance
+};
+
+// Relevance mode sorts only this many results by score; similarity mode keeps only this many
+constexpr size_t kRelevanceTopK = 200;
+
+// Runs every filter of the search window and returns matching recipes in display order:
+// file order, by matched quantity (descending) when include_less_equal is set, the top
+// kRelevanceTopK by BM25 score followed by the other matches in file order when
+// rank_by_relevance is set, or by cosine similarity to
+// similar_to (its kRelevanceTopK nearest matches) when that is not empty.
+// When *cancelled becomes true the search stops early and returns an incomplete list.
+// explain, if given, receives the advanced query's annotated plan or its syntax error.
+// facet_counts, if given, receives the number of matches under every cuisine category node,
+// counted before the facet itself narrows the results so sibling categories keep their counts.
+std::vector<SearchResult> run_search(const SearchQuery& query, const std::atomic<bool>* cancelled = nullptr,
+                                     std::string* explain = nullptr, std::vector<uint32_t>* facet_counts = nullptr);
@@ -0,0 +1,375 @@
+#include <algorithm>
+#include <cctype>
+
+#include "searchIndex.hpp"
+#include "ingredientDictionary.hpp"
+
+SearchIndex searchIndex;
+
+// Distinct ingredient ids referenced by a recipe
+static std::vector<uint32_t> recipe_ingredient_ids(const Recipe& recipe) {
+    std::vector<uint32_t> ids;
+    for (const Ingredient& ing : recipe.ingredients) {
+        if (ing.canonical_id != kNoIngredientId) ids.push_back(ing.canonical_id);
+        ids.insert(ids.end(), ing.tags.begin(), ing.tags.end());
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+void NumericColumn::add(double value, uint32_t recipe_id) {
+    std::pair<double, uint32_t> entry(value, recipe_id);
+    entries.insert(std::upper_bound(entries.begin(), entries.end(), entry), entry);
+}
+
+std::vector<uint32_t> NumericColumn::recipes_in_range(double lo, double hi) const {
+    auto first = std::lower_bound(entries.begin(), entries.end(), std::make_pair(lo, uint32_t(0)));
+    auto last = std::upper_bound(entries.begin(), entries.end(), std::make_pair(hi, UINT32_MAX));
+    std::vector<uint32_t> ids;
+    if (first >= last) return ids;
+    ids.reserve(last - first);
+    for (auto it = first; it != last; ++it) ids.push_back(it->second);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+size_t NumericColumn::count_in_range(double lo, double hi) const {
+    auto first = std::lower_bound(entries.begin(), entries.end(), std::make_pair(lo, uint32_t(0)));
+    auto last = std::upper_bound(entries.begin(), entries.end(), std::make_pair(hi, UINT32_MAX));
+    return first < last ? static_cast<size_t>(last - first) : 0;
+}
+
+// Display order of the lesser-quantity mode: larger amounts first, then lower recipe ids
+static bool quantity_order(const QuantityEntry& a, const QuantityEntry& b) {
+    if (a.amount != b.amount) return a.amount > b.amount;
+    return a.recipe_id < b.recipe_id;
+}
+
+static uint32_t pack_gram(const std::string& s, size_t pos, size_t n) {
+    uint32_t key = 0;
+    for (size_t k = 0; k < n; ++k) key = (key << 8) | static_cast<unsigned char>(s[pos + k]);
+    return key;
+}
+
+// Distinct n-grams of a string, sorted
+static std::vector<uint32_t> distinct_grams(const std::string& s, size_t n) {
+    std::vector<uint32_t> grams;
+    if (s.size() < n) return grams;
+    grams.reserve(s.size() - n + 1);
+    for (size_t pos = 0; pos + n <= s.size(); ++pos) grams.push_back(pack_gram(s, pos, n));
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+void SearchIndex::clear() {
+    ingredient_postings.clear();
+    name_trigrams.clear();
+    name_bigrams.clear();
+    name_bytes.clear();
+    ingredient_keys.clear();
+    quantity_postings.clear();
+    quantity_units.clear();
+    quantity_unit_ids.clear();
+    total_minutes.clear();
+    prep_minutes.clear();
+    cook_minutes.clear();
+    rating.clear();
+    ingredient_categories.clear();
+    recipe_categories.clear();
+    cuisines.clear();
+    similarity.clear();
+    vectors.clear();
+    nutrition.clear();
+    name_completions.clear();
+    ingredient_completions.clear();
+    relevance.clear();
+    directions.clear();
+    name_terms.clear();
+    ingredient_terms.clear();
+}
+
+void SearchIndex::index_quantities(uint32_t recipe_id, bool keep_sorted) {
+    if (quantity_postings.size() < ingredientDictionary.size())
+        quantity_postings.resize(ingredientDictionary.size());
+
+    for (const Ingredient& ing : recipes[recipe_id].ingredients) {
+        auto [it, added] = quantity_unit_ids.emplace(ing.unit_key, static_cast<uint32_t>(quantity_units.size()));
+        if (added) quantity_units.push_back(ing.unit_key);
+
+        QuantityEntry entry{ing.amount, recipe_id, it->second};
+
+        std::vector<uint32_t> ids = ing.tags;
+        if (ing.canonical_id != kNoIngredientId) ids.push_back(ing.canonical_id);
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        for (uint32_t id : ids) {
+            std::vector<QuantityEntry>& list = quantity_postings[id];
+            if (keep_sorted) list.insert(std::upper_bound(list.begin(), list.end(), entry, quantity_order), entry);
+            else list.push_back(entry);
+        }
+    }
+}
+
+void SearchIndex::index_relevance(uint32_t recipe_id) {
+    const Recipe& r = recipes[recipe_id];
+    std::string ingredient_text;
+    for (const Ingredient& ing : r.ingredients) ingredient_text += ing.unit + " " + ing.name + "\n";
+    relevance.add_document(recipe_id, {r.name, ingredient_text, r.directions});
+}
+
+void SearchIndex::index_times(uint32_t recipe_id) {
+    const Recipe& r = recipes[recipe_id];
+    if (r.total_minutes >= 0) total_minutes.add(r.total_minutes, recipe_id);
+    if (r.prep_minutes >= 0) prep_minutes.add(r.prep_minutes, recipe_id);
+    if (r.cook_minutes >= 0) cook_minutes.add(r.cook_minutes, recipe_id);
+    if (r.rating >= 0) rating.add(r.rating, recipe_id);
+}
+
+// A line counts with the categories of its canonical ingredient and of its own text, which keeps
+// words the canonical form dropped. Entity tags are left out: "peanut butter" is tagged "butter".
+void SearchIndex::index_categories(uint32_t recipe_id) {
+    while (ingredient_categories.size() < ingredientDictionary.size())
+        ingredient_categories.push_back(categorize_ingredient_name(ingredientDictionary.names[ingredient_categories.size()]));
+
+    CategoryMask mask = 0;
+    for (const Ingredient& ing : recipes[recipe_id].ingredients) {
+        if (ing.canonical_id != kNoIngredientId) mask |= ingredient_categories[ing.canonical_id];
+        mask |= categorize_ingredient_name(ing.name_key);
+    }
+    if (recipe_categories.size() <= recipe_id) recipe_categories.resize(recipe_id + 1);
+    recipe_categories[recipe_id] = mask;
+}
+
+void SearchIndex::build_completions() {
+    std::vector<std::pair<std::string, std::string>> names;
+    names.reserve(recipes.size());
+    for (uint32_t r = 0; r < recipes.size(); ++r) names.emplace_back(recipes[r].name_key, recipes[r].name);
+    name_completions.build(std::move(names), std::vector<uint32_t>(recipes.size(), 1));
+
+    std::vector<std::pair<std::string, std::string>> ingredients;
+    ingredients.reserve(ingredientDictionary.size());
+    for (const std::string& name : ingredientDictionary.names) ingredients.emplace_back(name, name);
+    ingredient_completions.build(std::move(ingredients), ingredientDictionary.frequency);
+}
+
+// Recipe ids only ever grow, so pushing onto the lists keeps them sorted
+void SearchIndex::index_name(uint32_t recipe_id) {
+    const std::string& name = recipes[recipe_id].name_key;
+
+    for (uint32_t gram : distinct_grams(name, 3)) name_trigrams[gram].push_back(recipe_id);
+    for (uint32_t gram : distinct_grams(name, 2)) name_bigrams[gram].push_back(recipe_id);
+    if (name_bytes.empty()) name_bytes.resize(256);
+    for (uint32_t gram : distinct_grams(name, 1)) name_bytes[gram].push_back(recipe_id);
+
+    for (const std::string& word : split_vocabulary_words(name)) name_terms.add_term(word);
+}
+
+void SearchIndex::index_substring_keys(uint32_t recipe_id) {
+    for (const Ingredient& ing : recipes[recipe_id].ingredients) ingredient_keys.add(recipe_id, ing.name_key);
+}
+
+// Words of the canonical names a recipe uses, counted once per ingredient line
+void SearchIndex::index_ingredient_terms(uint32_t recipe_id) {
+    for (const Ingredient& ing : recipes[recipe_id].ingredients) {
+        if (ing.canonical_id == kNoIngredientId) continue;
+        for (const std::string& word : split_vocabulary_words(ingredientDictionary.names[ing.canonical_id]))
+            ingredient_terms.add_term(word);
+    }
+}
+
+void SearchIndex::build() {
+    clear();
+    ingredient_postings.resize(ingredientDictionary.size());
+
+    // Recipes are visited in id order, so every posting list comes out sorted
+    for (uint32_t r = 0; r < recipes.size(); ++r) {
+        for (uint32_t id : recipe_ingredient_ids(recipes[r])) {
+            ingredient_postings[id].push_back(r);
+        }
+    }
+
+    for (uint32_t r = 0; r < recipes.size(); ++r) {
+        index_name(r);
+        index_substring_keys(r);
+        index_ingredient_terms(r);
+        index_quantities(r, false);
+        index_relevance(r);
+        index_categories(r);
+    }
+    for (std::vector<QuantityEntry>& list : quantity_postings)
+        std::sort(list.begin(), list.end(), quantity_order);
+
+    std::vector<const std::string*> direction_texts;
+    direction_texts.reserve(recipes.size());
+    for (const Recipe& r : recipes) direction_texts.push_back(&r.directions);
+    directions.build(direction_texts);
+
+    // Build the numeric columns with one sort each instead of sorted inserts
+    for (uint32_t r = 0; r < recipes.size(); ++r) {
+        if (recipes[r].total_minutes >= 0) total_minutes.entries.emplace_back(recipes[r].total_minutes, r);
+        if (recipes[r].prep_minutes >= 0) prep_minutes.entries.emplace_back(recipes[r].prep_minutes, r);
+        if (recipes[r].cook_minutes >= 0) cook_minutes.entries.emplace_back(recipes[r].cook_minutes, r);
+        if (recipes[r].rating >= 0) rating.entries.emplace_back(recipes[r].rating, r);
+    }
+    for (NumericColumn* column : {&total_minutes, &prep_minutes, &cook_minutes, &rating})
+        std::sort(column->entries.begin(), column->entries.end());
+
+    cuisines.build();
+    similarity.build();
+    nutrition.build();
+    build_completions();
+}
+
+void SearchIndex::add_recipe(uint32_t recipe_id) {
+    if (ingredient_postings.size() < ingredientDictionary.size())
+        ingredient_postings.resize(ingredientDictionary.size());
+
+    // Appended recipes always have the largest id, so pushing keeps the lists sorted
+    for (uint32_t id : recipe_ingredient_ids(recipes[recipe_id])) {
+        ingredient_postings[id].push_back(recipe_id);
+    }
+    index_name(recipe_id);
+    index_substring_keys(recipe_id);
+    index_ingredient_terms(recipe_id);
+    index_quantities(recipe_id, true);
+    index_relevance(recipe_id);
+    index_times(recipe_id);
+    index_categories(recipe_id);
+    cuisines.add_recipe(recipe_id);
+    similarity.add_recipe(recipe_id);
+    vectors.add_recipe(recipe_id);
+    nutrition.add_recipe(recipe_id);
+    directions.add_document(recipe_id, recipes[recipe_id].directions);
+    // The tries are static arrays; rebuilding them costs a few milliseconds per added recipe
+    build_completions();
+}
+
+std::vector<uint32_t> SearchIndex::recipes_with_any(const std::vector<uint32_t>& ingredient_ids) const {
+    std::vector<uint32_t> result, postings, merged;
+    for (uint32_t id : ingredient_ids) {
+        if (id >= ingredient_postings.size()) continue;
+        ingredient_postings[id].decode_into(postings);
+        union_sorted(result, postings, merged);
+        result.swap(merged);
+    }
+    return result;
+}
+
+std::vector<uint32_t> SearchIndex::recipes_with_name_substring(const std::string& folded_query) const {
+    std::vector<uint32_t> result;
+    if (folded_query.empty()) {
+        result.resize(recipes.size());
+        for (uint32_t r = 0; r < result.size(); ++r) result[r] = r;
+        return result;
+    }
+
+    // Every gram of the query must appear in a matching name, so the candidates are the
+    // intersection of the query's posting lists
+    const size_t n = std::min<size_t>(folded_query.size(), 3);
+    std::vector<const CompressedPostings*> lists;
+    for (uint32_t gram : distinct_grams(folded_query, n)) {
+        const CompressedPostings* postings = nullptr;
+        if (n == 1) {
+            if (!name_bytes.empty()) postings = &name_bytes[gram];
+        } else {
+            const auto& table = n == 3 ? name_trigrams : name_bigrams;
+            auto it = table.find(gram);
+            if (it != table.end()) postings = &it->second;
+        }
+        if (!postings || postings->empty()) return result;
+        lists.push_back(postings);
+    }
+
+    // Smallest list first keeps every intermediate result as short as possible
+    std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+    // Only the smallest list is decoded in full; the others skip every block the candidates miss
+    lists[0]->decode_into(result);
+    for (size_t k = 1; k < lists.size() && !result.empty(); ++k) {
+        result = lists[k]->intersect(result);
+    }
+
+    // Grams can co-occur without being adjacent, so each candidate is confirmed against its name.
+    // Queries of up to three bytes are a single gram and need no verification.
+    if (folded_query.size() > 3) {
+        result.erase(std::remove_if(result.begin(), result.end(), [&](uint32_t r) {
+            return recipes[r].name_key.find(folded_query) == std::string::npos;
+        }), result.end());
+    }
+    return result;
+}
+
+std::vector<uint32_t> SearchIndex::recipes_with_at_most(const std::vector<uint32_t>& ingredient_ids, double max_amount,
+                                                      const std::vector<char>& unit_allowed,
+                                                      const std::vector<char>& recipe_allowed) const {
+    // One cursor per ingredient id, starting at its first line with amount <= max_amount. Lines
+    // come out of the merge in display order, so a recipe's first accepted line is its best one.
+    struct Cursor {
+        const QuantityEntry* at;
+        const QuantityEntry* end;
+    };
+    auto later = [](const Cursor& a, const Cursor& b) { return quantity_order(*b.at, *a.at); };
+    std::vector<Cursor> heap;
+    for (uint32_t id : ingredient_ids) {
+        if (id >= quantity_postings.size()) continue;
+        const std::vector<QuantityEntry>& list = quantity_postings[id];
+        auto first = std::partition_point(list.begin(), list.end(),
+                                          [&](const QuantityEntry& e) { return e.amount > max_amount; });
+        if (first != list.end()) heap.push_back({&*first, list.data() + list.size()});
+    }
+    std::make_heap(heap.begin(), heap.end(), later);
+
+    std::vector<uint32_t> result;
+    std::vector<char> seen(recipes.size(), 0);
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        Cursor& cursor = heap.back();
+        const QuantityEntry& e = *cursor.at;
+        bool allowed = (unit_allowed.empty() || unit_allowed[e.unit_id]) &&
+                       (recipe_allowed.empty() || recipe_allowed[e.recipe_id]);
+        if (allowed && !seen[e.recipe_id]) {
+            seen[e.recipe_id] = 1;
+            result.push_back(e.recipe_id);
+        }
+        if (++cursor.at == cursor.end) heap.pop_back();
+        else std::push_heap(heap.begin(), heap.end(), later);
+    }
+    return result;
+}
+
+size_t SearchIndex::estimate_name_substring(const std::string& folded_query) const {
+    if (folded_query.empty()) return recipes.size();
+    const size_t n = std::min<size_t>(folded_query.size(), 3);
+    size_t estimate = recipes.size();
+    for (uint32_t gram : distinct_grams(folded_query, n)) {
+        size_t size = 0;
+        if (n == 1) {
+            if (!name_bytes.empty()) size = name_bytes[gram].size();
+        } else {
+            const auto& table = n == 3 ? name_trigrams : name_bigrams;
+            auto it = table.find(gram);
+            if (it != table.end()) size = it->second.size();
+        }
+        estimate = std::min(estimate, size);
+    }
+    return estimate;
+}
+
+size_t SearchIndex::postings_memory_bytes() const {
+    size_t bytes = 0;
+    for (const CompressedPostings& list : ingredient_postings) bytes += list.memory_bytes();
+    for (const auto& [gram, list] : name_trigrams) bytes += list.memory_bytes();
+    for (const auto& [gram, list] : name_bigrams) bytes += list.memory_bytes();
+    for (const CompressedPostings& list : name_bytes) bytes += list.memory_bytes();
+    return bytes;
+}
+
+size_t SearchIndex::postings_count() const {
+    size_t count = 0;
+    for (const CompressedPostings& list : ingredient_postings) count += list.size();
+    for (const auto& [gram, list] : name_trigrams) count += list.size();
+    for (const auto& [gram, list] : name_bigrams) count += list.size();
+    for (const CompressedPostings& list : name_bytes) count += list.size();
+    return count;
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "data.hpp"
+#include "postingList.hpp"
+#include "packedKeys.hpp"
+#include "symSpell.hpp"
+#include "bm25.hpp"
+#include "positionalIndex.hpp"
+#include "dietTaxonomy.hpp"
+#include "completionTrie.hpp"
+#include "facetTree.hpp"
+#include "similarRecipes.hpp"
+#include "vectorIndex.hpp"
+
+// Numeric attribute of every recipe kept sorted by value, so range filters are two binary searches
+struct NumericColumn {
+    std::vector<std::pair<double, uint32_t>> entries; // (value, recipe id) in ascending order
+
+    // Recipes without a value are simply not added
+    void add(double value, uint32_t recipe_id);
+    void clear() { entries.clear(); }
+
+    // Sorted ids of the recipes with lo <= value <= hi
+    std::vector<uint32_t> recipes_in_range(double lo, double hi) const;
+    size_t count_in_range(double lo, double hi) const;
+};
+
+// One ingredient line as seen by the "lesser quantity" filter
+struct QuantityEntry {
+    double amount;       // parsed quantity, -1 when the line has none
+    uint32_t recipe_id;
+    uint32_t unit_id;    // index into SearchIndex::quantity_units
+};
+
+// Inverted index over the recipe list, built at load and extended as recipes are appended.
+// Recipe ids are positions in the global recipes vector.
+struct SearchIndex {
+    // Sorted recipe ids per canonical ingredient id (the line's own id and every entity it is tagged with)
+    std::vector<CompressedPostings> ingredient_postings;
+
+    // Sorted recipe ids per byte n-gram of the recipe's name_key. Trigrams answer queries of three or
+    // more bytes; bigrams and single bytes cover the shorter ones.
+    std::unordered_map<uint32_t, CompressedPostings> name_trigrams;
+    std::unordered_map<uint32_t, CompressedPostings> name_bigrams;
+    std::vector<CompressedPostings> name_bytes;
+
+    // Every ingredient line's name_key packed for SIMD substring scans, the path for ingredient
+    // text that resolves to no canonical id. Names stay on the n-gram index, which is faster.
+    PackedKeys ingredient_keys;
+
+    // Per canonical ingredient id, every line linked or tagged with it, ordered by amount
+    // descending and then recipe id ascending: the display order of the lesser-quantity mode
+    std::vector<std::vector<QuantityEntry>> quantity_postings;
+    std::vector<std::string> quantity_units; // distinct unit keys (see Ingredient::unit_key)
+    std::unordered_map<std::string, uint32_t> quantity_unit_ids;
+
+    // Total, prep and cook time in minutes
+    NumericColumn total_minutes;
+    NumericColumn prep_minutes;
+    NumericColumn cook_minutes;
+    NumericColumn rating;
+
+    // Nutrition facts and rating as contiguous float columns for SIMD range scans
+    NutritionColumns nutrition;
+
+    // Allergen and diet categories per canonical ingredient id, and their union per recipe, so the
+    // exclusion filters are one AND per candidate
+    std::vector<CategoryMask> ingredient_categories;
+    std::vector<CategoryMask> recipe_categories;
+
+    // MinHash/LSH buckets over canonical ingredient sets, for "More like this" and duplicate reports
+    MinHashIndex similarity;
+
+    // Category tree from the cuisine_path column, with a recipe bitset per node
+    FacetTree cuisines;
+
+    // Word positions in the directions, for term, phrase and proximity queries
+    PositionalIndex directions;
+
+    // BM25 statistics over name, ingredient and directions text
+    Bm25Index relevance;
+
+    // Hashed TF-IDF vectors with an HNSW graph for the Similar To box. build() leaves it empty:
+    // load_recipes reads it from disk or builds it (see VectorIndex::load_or_build).
+    VectorIndex vectors;
+
+    // Spelling vocabularies for fuzzy search: words of recipe names and of canonical ingredient names
+    SymSpell name_terms;
+    SymSpell ingredient_terms;
+
+    // Prefix completion for the Dish Name and Ingredient Name boxes, weighted by how often each
+    // name occurs
+    CompletionTrie name_completions;
+    CompletionTrie ingredient_completions;
+
+    void build();
+    void add_recipe(uint32_t recipe_id);
+    void clear();
+
+    // Sorted union of the posting lists of the given ingredient ids
+    std::vector<uint32_t> recipes_with_any(const std::vector<uint32_t>& ingredient_ids) const;
+
+    // Sorted ids of recipes whose name_key contains folded_query (which must already be folded,
+    // see fold_case)
+    std::vector<uint32_t> recipes_with_name_substring(const std::string& folded_query) const;
+    // Upper bound on that result: the shortest posting list among the query's grams
+    size_t estimate_name_substring(const std::string& folded_query) const;
+
+    // Recipes with a line of one of the ingredient ids whose amount is at most max_amount, ordered by
+    // their largest such amount (descending) and then by id. unit_allowed (by unit id) and
+    // recipe_allowed (by recipe id) restrict the lines considered; empty masks allow everything.
+    std::vector<uint32_t> recipes_with_at_most(const std::vector<uint32_t>& ingredient_ids, double max_amount,
+                                               const std::vector<char>& unit_allowed,
+                                               const std::vector<char>& recipe_allowed) const;
+
+    // Bytes held by all posting lists, and the number of postings they store
+    size_t postings_memory_bytes() const;
+    size_t postings_count() const;
+
+private:
+    void index_name(uint32_t recipe_id);
+    void index_substring_keys(uint32_t recipe_id);
+    void index_ingredient_terms(uint32_t recipe_id);
+    void index_times(uint32_t recipe_id);
+    void index_categories(uint32_t recipe_id);
+    void build_completions();
+    void index_relevance(uint32_t recipe_id);
+    void index_quantities(uint32_t recipe_id, bool keep_sorted);
+};
+
+extern SearchIndex searchIndex;
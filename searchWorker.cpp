@@ -0,0 +1,154 @@
+#include <chrono>
+#include <shared_mutex>
+
+#include "searchWorker.hpp"
+
+SearchWorker::SearchWorker(int debounce_ms)
+    : debounce_ms(debounce_ms), published(std::make_shared<SearchOutcome>()),
+      published_pantry(std::make_shared<PantryOutcome>()) {
+    worker = std::thread(&SearchWorker::worker_loop, this);
+}
+
+SearchWorker::~SearchWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cancel = true;
+    wake.notify_all();
+    worker.join();
+}
+
+void SearchWorker::submit(const SearchQuery& query) {
+    const uint64_t generation = dataset_generation();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (has_submitted && query == pending_query && generation == pending_generation) return;
+        pending_query = query;
+        pending_generation = generation;
+        has_submitted = true;
+        ++pending_seq;
+        // Whatever is running now is stale; set under the lock so it cannot land after the
+        // worker has picked up this query and cleared the flag
+        cancel = true;
+    }
+    wake.notify_all();
+}
+
+std::shared_ptr<const SearchOutcome> SearchWorker::latest() const {
+    return std::atomic_load(&published);
+}
+
+void SearchWorker::submit_pantry(const std::vector<std::string>& items, PantryRank order) {
+    const uint64_t generation = dataset_generation();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (has_submitted_pantry && items == pantry_items && order == pantry_order && generation == pantry_generation)
+            return;
+        pantry_items = items;
+        pantry_order = order;
+        pantry_generation = generation;
+        has_submitted_pantry = true;
+        ++pantry_seq;
+    }
+    wake.notify_all();
+}
+
+std::shared_ptr<const PantryOutcome> SearchWorker::latest_pantry() const {
+    return std::atomic_load(&published_pantry);
+}
+
+void SearchWorker::cancel_current() {
+    std::lock_guard<std::mutex> lock(mutex);
+    cancelled_seq = pending_seq.load();
+    has_submitted = false;
+    cancel = true;
+}
+
+void SearchWorker::set_on_publish(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    on_publish = std::move(callback);
+}
+
+void SearchWorker::notify_publish(std::unique_lock<std::mutex>& lock) {
+    std::function<void()> callback = on_publish;
+    lock.unlock();
+    if (callback) callback();
+    lock.lock();
+}
+
+void SearchWorker::worker_loop() {
+    uint64_t done_seq = 0, pantry_done_seq = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] {
+            return stopping || pending_seq.load() != done_seq || pantry_seq.load() != pantry_done_seq;
+        });
+        if (stopping) return;
+
+        // Pantry rankings come from clicks and take microseconds, so they skip the debounce
+        if (pantry_seq.load() != pantry_done_seq) {
+            uint64_t seq = pantry_seq.load();
+            auto outcome = std::make_shared<PantryOutcome>();
+            outcome->items = pantry_items;
+            outcome->order = pantry_order;
+            lock.unlock();
+            {
+                std::shared_lock<std::shared_mutex> dataset_lock(dataset_mutex());
+                outcome->generation = dataset_generation();
+                outcome->pantry = make_pantry_set(outcome->items);
+                if (!outcome->items.empty()) outcome->matches = pantryIndex.rank(outcome->pantry, outcome->order);
+            }
+            lock.lock();
+            pantry_done_seq = seq;
+            if (pantry_seq.load() != seq) continue;
+
+            std::atomic_store(&published_pantry, std::shared_ptr<const PantryOutcome>(std::move(outcome)));
+            published_pantry_seq = seq;
+            notify_publish(lock);
+            continue;
+        }
+
+        // Debounce: keep waiting while new snapshots keep arriving
+        uint64_t seq = pending_seq.load();
+        while (wake.wait_for(lock, std::chrono::milliseconds(debounce_ms),
+                             [&] { return stopping || pending_seq.load() != seq; })) {
+            if (stopping) return;
+            seq = pending_seq.load();
+        }
+
+        // Dropped by cancel_current while it waited
+        if (seq <= cancelled_seq) {
+            done_seq = seq;
+            continue;
+        }
+        SearchQuery query = pending_query;
+        cancel = false;
+        lock.unlock();
+
+        auto outcome = std::make_shared<SearchOutcome>();
+        auto start = std::chrono::steady_clock::now();
+        {
+            // Appends take the dataset lock exclusively, so the recipes and indexes stay put
+            std::shared_lock<std::shared_mutex> dataset_lock(dataset_mutex());
+            outcome->generation = dataset_generation();
+            outcome->results = run_search(query, &cancel, &outcome->explain, &outcome->facet_counts);
+        }
+        outcome->query = query;
+        outcome->millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        done_seq = seq;
+        // A newer submit cancelled this run (or will supersede it); its partial result is dropped
+        if (cancel || pending_seq.load() != seq) continue;
+
+        std::atomic_store(&published, std::shared_ptr<const SearchOutcome>(std::move(outcome)));
+        published_seq = seq;
+        notify_publish(lock);
+    }
+}
+
+SearchWorker& search_worker() {
+    static SearchWorker worker;
+    return worker;
+}
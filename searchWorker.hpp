@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "pantryIndex.hpp"
+#include "recipeSearch.hpp"
+
+// A finished search, published as one immutable snapshot
+struct SearchOutcome {
+    SearchQuery query;
+    uint64_t generation = 0;
+    std::vector<SearchResult> results;
+    double millis = 0.0;
+    std::string explain; // plan of the advanced query, if any
+    std::vector<uint32_t> facet_counts; // matches per cuisine category node
+};
+
+// A finished pantry ranking, published the same way
+struct PantryOutcome {
+    std::vector<std::string> items;
+    PantryRank order = PantryRank::Coverage;
+    uint64_t generation = 0;
+    PantrySet pantry;
+    std::vector<PantryMatch> matches;
+};
+
+// Runs run_search on a background thread so the UI frame never waits on a query.
+// submit() only records the newest query: snapshots typed in quick succession are debounced,
+// a search made stale by a newer submit is cancelled, and the UI reads whichever outcome
+// was published last. Pantry rankings run on the same thread and are published alongside.
+class SearchWorker {
+public:
+    explicit SearchWorker(int debounce_ms = 80);
+    ~SearchWorker();
+
+    SearchWorker(const SearchWorker&) = delete;
+    SearchWorker& operator=(const SearchWorker&) = delete;
+
+    // Queues the query unless it matches the last one submitted for the current dataset generation
+    void submit(const SearchQuery& query);
+
+    // Latest published outcome; never null (empty before the first search finishes)
+    std::shared_ptr<const SearchOutcome> latest() const;
+
+    // True while a submitted query has not been published yet
+    bool busy() const { return pending_seq.load() != published_seq.load(); }
+
+    // Queues a pantry ranking unless it matches the last one submitted for the current generation
+    void submit_pantry(const std::vector<std::string>& items, PantryRank order);
+    std::shared_ptr<const PantryOutcome> latest_pantry() const;
+    bool pantry_busy() const { return pantry_seq.load() != published_pantry_seq.load(); }
+
+    // Stops the running search and drops the queued one, so the caller can take the dataset lock
+    // exclusively without waiting out a whole search; the next submit is always queued
+    void cancel_current();
+
+    // Called from the worker thread after each publish, e.g. to wake an idle event loop
+    void set_on_publish(std::function<void()> callback);
+
+private:
+    void worker_loop();
+    void notify_publish(std::unique_lock<std::mutex>& lock);
+
+    const int debounce_ms;
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    SearchQuery pending_query;
+    uint64_t pending_generation = 0;
+    bool has_submitted = false;
+    std::atomic<uint64_t> pending_seq{0};   // bumped by every accepted submit
+    std::atomic<uint64_t> published_seq{0}; // seq of the outcome in `published`
+    std::atomic<bool> cancel{false};
+    uint64_t cancelled_seq = 0;             // submits up to this seq were dropped by cancel_current
+
+    std::vector<std::string> pantry_items;
+    PantryRank pantry_order = PantryRank::Coverage;
+    uint64_t pantry_generation = 0;
+    bool has_submitted_pantry = false;
+    std::atomic<uint64_t> pantry_seq{0};
+    std::atomic<uint64_t> published_pantry_seq{0};
+
+    std::shared_ptr<const SearchOutcome> published;
+    std::shared_ptr<const PantryOutcome> published_pantry;
+    std::function<void()> on_publish;
+};
+
+// The worker shared by the search and pantry windows and the recipe form
+SearchWorker& search_worker();
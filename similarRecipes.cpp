@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+
+#include "similarRecipes.hpp"
+#include "data.hpp"
+
+// splitmix64 finalizer
+static uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// MinHash signature of a non-empty id set, folded into one bucket key per band. Hash i of an id is
+// mix(id ^ seed_i), and the signature keeps the minimum of each hash over the set.
+static void band_keys(const std::vector<uint32_t>& set, uint64_t keys[MinHashIndex::kBands]) {
+    uint64_t signature[MinHashIndex::kHashes];
+    std::fill(std::begin(signature), std::end(signature), UINT64_MAX);
+    for (uint32_t id : set) {
+        for (size_t i = 0; i < MinHashIndex::kHashes; ++i)
+            signature[i] = std::min(signature[i], mix(id ^ (0x51ed270b27f4e0e1ULL * (i + 1))));
+    }
+    for (size_t band = 0; band < MinHashIndex::kBands; ++band) {
+        uint64_t key = band;
+        for (size_t row = 0; row < MinHashIndex::kRowsPerBand; ++row)
+            key = mix(key ^ signature[band * MinHashIndex::kRowsPerBand + row]);
+        keys[band] = key;
+    }
+}
+
+void MinHashIndex::clear() {
+    sets.clear();
+    buckets.clear();
+}
+
+void MinHashIndex::build() {
+    clear();
+    sets.reserve(recipes.size());
+    for (uint32_t r = 0; r < recipes.size(); ++r) add_recipe(r);
+}
+
+void MinHashIndex::add_recipe(uint32_t recipe_id) {
+    if (buckets.empty()) buckets.resize(kBands);
+    if (sets.size() <= recipe_id) sets.resize(recipe_id + 1);
+
+    std::vector<uint32_t>& set = sets[recipe_id];
+    set.clear();
+    for (const Ingredient& ing : recipes[recipe_id].ingredients)
+        if (ing.canonical_id != kNoIngredientId) set.push_back(ing.canonical_id);
+    std::sort(set.begin(), set.end());
+    set.erase(std::unique(set.begin(), set.end()), set.end());
+    if (set.empty()) return; // nothing to compare; never a candidate
+
+    uint64_t keys[kBands];
+    band_keys(set, keys);
+    for (size_t band = 0; band < kBands; ++band) buckets[band][keys[band]].push_back(recipe_id);
+}
+
+float MinHashIndex::jaccard(uint32_t a, uint32_t b) const {
+    const std::vector<uint32_t>& x = sets[a];
+    const std::vector<uint32_t>& y = sets[b];
+    size_t shared = 0, i = 0, j = 0;
+    while (i < x.size() && j < y.size()) {
+        if (x[i] < y[j]) ++i;
+        else if (y[j] < x[i]) ++j;
+        else { ++shared; ++i; ++j; }
+    }
+    const size_t combined = x.size() + y.size() - shared;
+    return combined ? static_cast<float>(shared) / combined : 0.0f;
+}
+
+std::vector<SimilarRecipe> MinHashIndex::similar(uint32_t recipe_id, size_t max_results) const {
+    std::vector<SimilarRecipe> out;
+    if (recipe_id >= sets.size() || sets[recipe_id].empty()) return out;
+
+    // Candidates are the recipes sharing a bucket in any band
+    uint64_t keys[kBands];
+    band_keys(sets[recipe_id], keys);
+    std::vector<uint32_t> candidates;
+    for (size_t band = 0; band < kBands; ++band) {
+        auto it = buckets[band].find(keys[band]);
+        if (it != buckets[band].end()) candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    for (uint32_t other : candidates) {
+        if (other == recipe_id) continue;
+        float j = jaccard(recipe_id, other);
+        if (j > 0.0f) out.push_back({other, j});
+    }
+    std::sort(out.begin(), out.end(), [](const SimilarRecipe& a, const SimilarRecipe& b) {
+        return a.jaccard != b.jaccard ? a.jaccard > b.jaccard : a.recipe_id < b.recipe_id;
+    });
+    if (out.size() > max_results) out.resize(max_results);
+    return out;
+}
+
+// Every unordered pair that shares a bucket, each reported once
+template <typename Visit>
+static void for_each_candidate_pair(const std::vector<std::unordered_map<uint64_t, std::vector<uint32_t>>>& buckets,
+                                    Visit visit) {
+    std::unordered_set<uint64_t> seen;
+    for (const auto& band : buckets) {
+        for (const auto& [key, members] : band) {
+            for (size_t i = 0; i < members.size(); ++i) {
+                for (size_t j = i + 1; j < members.size(); ++j) {
+                    uint64_t pair = (uint64_t(members[i]) << 32) | members[j]; // members are in id order
+                    if (seen.insert(pair).second) visit(members[i], members[j]);
+                }
+            }
+        }
+    }
+}
+
+std::vector<DuplicatePair> MinHashIndex::near_duplicates(float min_jaccard) const {
+    std::vector<DuplicatePair> out;
+    for_each_candidate_pair(buckets, [&](uint32_t a, uint32_t b) {
+        float j = jaccard(a, b);
+        if (j >= min_jaccard) out.push_back({a, b, j});
+    });
+    std::sort(out.begin(), out.end(), [](const DuplicatePair& x, const DuplicatePair& y) {
+        if (x.jaccard != y.jaccard) return x.jaccard > y.jaccard;
+        return x.first != y.first ? x.first < y.first : x.second < y.second;
+    });
+    return out;
+}
+
+size_t MinHashIndex::candidate_pairs() const {
+    size_t count = 0;
+    for_each_candidate_pair(buckets, [&](uint32_t, uint32_t) { ++count; });
+    return count;
+}
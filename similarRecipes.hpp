@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct SimilarRecipe {
+    uint32_t recipe_id;
+    float jaccard;  // exact Jaccard similarity of the canonical ingredient sets
+};
+
+struct DuplicatePair {
+    uint32_t first;
+    uint32_t second;
+    float jaccard;
+};
+
+// MinHash signatures of each recipe's canonical ingredient set, bucketed with LSH. The signature
+// is split into bands of a few rows; two recipes become candidates when any band matches exactly,
+// which happens with high probability once their Jaccard similarity passes roughly
+// (1/kBands)^(1/kRowsPerBand). Candidates are then ranked by their exact Jaccard similarity.
+class MinHashIndex {
+public:
+    static constexpr size_t kHashes = 64;
+    static constexpr size_t kRowsPerBand = 2;
+    static constexpr size_t kBands = kHashes / kRowsPerBand; // candidate threshold near 0.18
+
+    void build();
+    void add_recipe(uint32_t recipe_id);
+    void clear();
+
+    // The recipes most similar to recipe_id, best first, at most max_results of them
+    std::vector<SimilarRecipe> similar(uint32_t recipe_id, size_t max_results) const;
+
+    // Every pair of recipes with Jaccard similarity of at least min_jaccard, most similar first
+    std::vector<DuplicatePair> near_duplicates(float min_jaccard) const;
+
+    // Recipe pairs sharing at least one bucket, i.e. how many exact comparisons LSH asked for
+    size_t candidate_pairs() const;
+
+private:
+    float jaccard(uint32_t a, uint32_t b) const;
+
+    std::vector<std::vector<uint32_t>> sets;                     // sorted canonical ids per recipe
+    std::vector<std::unordered_map<uint64_t, std::vector<uint32_t>>> buckets; // per band: band hash -> recipes
+};
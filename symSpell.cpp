@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <unordered_set>
+
+#include "symSpell.hpp"
+
+SymSpell::SymSpell(int max_distance, size_t prefix_length)
+    : max_distance(max_distance), prefix_length(prefix_length) {}
+
+void SymSpell::clear() {
+    terms.clear();
+    counts.clear();
+    term_ids.clear();
+    deletes.clear();
+}
+
+void SymSpell::add_deletes(const std::string& s, int depth, uint32_t id) {
+    std::vector<uint32_t>& ids = deletes[s];
+    if (!ids.empty() && ids.back() == id) return; // already reached through another delete path
+    ids.push_back(id);
+    if (depth == max_distance || s.size() <= 1) return;
+    for (size_t i = 0; i < s.size(); ++i) {
+        add_deletes(s.substr(0, i) + s.substr(i + 1), depth + 1, id);
+    }
+}
+
+void SymSpell::add_term(const std::string& term) {
+    if (term.empty()) return;
+    auto it = term_ids.find(term);
+    if (it != term_ids.end()) {
+        ++counts[it->second];
+        return;
+    }
+    uint32_t id = static_cast<uint32_t>(terms.size());
+    terms.push_back(term);
+    counts.push_back(1);
+    term_ids.emplace(term, id);
+    add_deletes(term.substr(0, prefix_length), 0, id);
+}
+
+// Optimal string alignment distance, abandoned once every cell of a row exceeds the limit
+static int bounded_edit_distance(const std::string& a, const std::string& b, int limit) {
+    const int n = static_cast<int>(a.size()), m = static_cast<int>(b.size());
+    if (std::abs(n - m) > limit) return limit + 1;
+
+    std::vector<int> prev2(m + 1), prev(m + 1), cur(m + 1);
+    for (int j = 0; j <= m; ++j) prev[j] = j;
+    for (int i = 1; i <= n; ++i) {
+        cur[0] = i;
+        int row_min = cur[0];
+        for (int j = 1; j <= m; ++j) {
+            int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+            cur[j] = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + cost});
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1])
+                cur[j] = std::min(cur[j], prev2[j - 2] + 1);
+            row_min = std::min(row_min, cur[j]);
+        }
+        if (row_min > limit) return limit + 1;
+        prev2.swap(prev);
+        prev.swap(cur);
+    }
+    return prev[m];
+}
+
+std::vector<FuzzyTerm> SymSpell::lookup(const std::string& query, int distance, size_t max_results) const {
+    std::vector<FuzzyTerm> found;
+    distance = std::min(distance, max_distance);
+    if (query.empty() || distance < 0) return found;
+
+    // Breadth-first over the deletes of the query prefix; each hit is verified on the full strings
+    const std::string prefix = query.substr(0, prefix_length);
+    std::vector<std::string> frontier{prefix};
+    std::unordered_set<std::string> seen_deletes{prefix};
+    std::unordered_set<uint32_t> seen_terms;
+    for (int depth = 0; depth <= distance && !frontier.empty(); ++depth) {
+        std::vector<std::string> next_frontier;
+        for (const std::string& candidate : frontier) {
+            auto it = deletes.find(candidate);
+            if (it != deletes.end()) {
+                for (uint32_t id : it->second) {
+                    if (!seen_terms.insert(id).second) continue;
+                    int d = bounded_edit_distance(query, terms[id], distance);
+                    if (d <= distance) found.push_back({id, d});
+                }
+            }
+            if (depth == distance || candidate.size() <= 1) continue;
+            for (size_t i = 0; i < candidate.size(); ++i) {
+                std::string shorter = candidate.substr(0, i) + candidate.substr(i + 1);
+                if (seen_deletes.insert(shorter).second) next_frontier.push_back(std::move(shorter));
+            }
+        }
+        frontier.swap(next_frontier);
+    }
+
+    std::sort(found.begin(), found.end(), [&](const FuzzyTerm& a, const FuzzyTerm& b) {
+        if (a.distance != b.distance) return a.distance < b.distance;
+        if (counts[a.term_id] != counts[b.term_id]) return counts[a.term_id] > counts[b.term_id];
+        return terms[a.term_id] < terms[b.term_id];
+    });
+    if (found.size() > max_results) found.resize(max_results);
+    return found;
+}
+
+int fuzzy_distance_for(const std::string& word) {
+    if (word.size() < 4) return 0;
+    if (word.size() <= 7) return 1;
+    return 2;
+}
+
+std::vector<std::string> split_vocabulary_words(const std::string& text) {
+    std::vector<std::string> words;
+    std::string word;
+    for (unsigned char c : text) {
+        if (std::isalnum(c)) {
+            word += static_cast<char>(std::tolower(c));
+        } else if (!word.empty()) {
+            words.push_back(word);
+            word.clear();
+        }
+    }
+    if (!word.empty()) words.push_back(word);
+    return words;
+}
+
+std::vector<std::string> expand_fuzzy_query(const SymSpell& vocabulary, const std::string& query, size_t max_expansions) {
+    std::vector<std::string> variants{query};
+    if (max_expansions <= 1) return variants;
+
+    // Per word: the word itself (it may be a prefix still being typed), then its corrections
+    const size_t per_word = 3;
+    std::vector<std::vector<std::string>> choices;
+    for (const std::string& word : split_vocabulary_words(query)) {
+        std::vector<std::string> options{word};
+        if (!vocabulary.contains(word)) {
+            for (const FuzzyTerm& t : vocabulary.lookup(word, fuzzy_distance_for(word), per_word))
+                options.push_back(vocabulary.term(t.term_id));
+        }
+        choices.push_back(std::move(options));
+    }
+    if (choices.empty()) return variants;
+
+    // Cartesian product of the choices, in order, stopping at the expansion budget
+    std::vector<size_t> pick(choices.size(), 0);
+    while (variants.size() < max_expansions) {
+        size_t k = choices.size();
+        while (k > 0 && ++pick[k - 1] == choices[k - 1].size()) pick[--k] = 0;
+        if (k == 0) break;
+
+        std::string variant;
+        for (size_t w = 0; w < choices.size(); ++w) {
+            if (w) variant += ' ';
+            variant += choices[w][pick[w]];
+        }
+        if (std::find(variants.begin(), variants.end(), variant) == variants.end()) variants.push_back(variant);
+    }
+    return variants;
+}
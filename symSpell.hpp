@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct FuzzyTerm {
+    uint32_t term_id;
+    int distance;
+};
+
+// Symmetric-delete spelling index (SymSpell). Every vocabulary term is stored under each string
+// reachable by deleting up to max_distance characters from its first prefix_length bytes, so a
+// lookup only has to generate the deletes of the query and verify the handful of terms they hit.
+class SymSpell {
+public:
+    explicit SymSpell(int max_distance = 2, size_t prefix_length = 7);
+
+    // Adds a lowercase term, or bumps the count of one already present
+    void add_term(const std::string& term);
+    void clear();
+
+    // Vocabulary terms within max_distance edits (optimal string alignment) of the query,
+    // closest first and then most frequent, at most max_results of them
+    std::vector<FuzzyTerm> lookup(const std::string& query, int max_distance, size_t max_results) const;
+
+    bool contains(const std::string& term) const { return term_ids.count(term) != 0; }
+    const std::string& term(uint32_t id) const { return terms[id]; }
+    size_t size() const { return terms.size(); }
+
+private:
+    void add_deletes(const std::string& s, int depth, uint32_t id);
+
+    int max_distance;
+    size_t prefix_length;
+    std::vector<std::string> terms;
+    std::vector<uint32_t> counts;
+    std::unordered_map<std::string, uint32_t> term_ids;
+    std::unordered_map<std::string, std::vector<uint32_t>> deletes; // delete string -> term ids
+};
+
+// Edits allowed for a query word: none below four letters, one up to seven, two beyond
+int fuzzy_distance_for(const std::string& word);
+
+// Rewrites a multi-word query into variants with misspelled words replaced by vocabulary terms.
+// The query itself always comes first; at most max_expansions variants are returned.
+std::vector<std::string> expand_fuzzy_query(const SymSpell& vocabulary, const std::string& query, size_t max_expansions);
+
+// Lowercase alphanumeric words of a text, as fed to the vocabularies
+std::vector<std::string> split_vocabulary_words(const std::string& text);
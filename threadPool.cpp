@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+
+#include "threadPool.hpp"
+
+ThreadPool::ThreadPool(size_t worker_count) {
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back([this] { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
+
+void ThreadPool::worker_loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) return;
+
+    // Several chunks per thread so uneven recipes still balance out
+    size_t threads = workers.size() + 1;
+    size_t chunk = std::max<size_t>(1, count / (threads * 8));
+    size_t chunk_count = (count + chunk - 1) / chunk;
+
+    if (workers.empty() || chunk_count == 1) {
+        body(0, count);
+        return;
+    }
+
+    // Shared with queued tasks, which may start after this call has already returned
+    struct Job {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto job = std::make_shared<Job>();
+
+    auto run_chunks = [job, &body, count, chunk, chunk_count]() {
+        size_t c;
+        while ((c = job->next.fetch_add(1)) < chunk_count) {
+            size_t begin = c * chunk;
+            body(begin, std::min(count, begin + chunk));
+            if (job->done.fetch_add(1) + 1 == chunk_count) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->finished.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(workers.size(), chunk_count - 1);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < helpers; ++i) {
+            // Late starters see next >= chunk_count and never touch body
+            tasks.emplace_back(run_chunks);
+        }
+    }
+    wake.notify_all();
+
+    run_chunks();
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finished.wait(lock, [&job, chunk_count] { return job->done.load() == chunk_count; });
+}
+
+static size_t configured_thread_count() {
+    if (const char* env = std::getenv("RECIPE_THREADS")) {
+        int n = std::atoi(env);
+        if (n > 0) return static_cast<size_t>(n);
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+static std::atomic<bool> parallel_switch{configured_thread_count() > 1};
+
+ThreadPool& shared_thread_pool() {
+    // The caller of parallel_for is one of the threads, so spawn one fewer
+    static ThreadPool pool(configured_thread_count() - 1);
+    return pool;
+}
+
+bool parallel_enabled() {
+    return parallel_switch.load();
+}
+
+void set_parallel_enabled(bool enabled) {
+    parallel_switch.store(enabled);
+}
+
+void parallel_for(size_t count, const std::function<void(size_t, size_t)>& body) {
+    if (!parallel_enabled()) {
+        body(0, count);
+        return;
+    }
+    shared_thread_pool().parallel_for(count, body);
+}
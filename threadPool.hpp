@@ -0,0 +1,43 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads shared by every bulk pass over the recipe list
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t worker_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // Split [0, count) into chunks and run body(begin, end) on each, blocking until all are done.
+    // The calling thread takes chunks too, so nested calls from inside a worker cannot deadlock.
+    void parallel_for(size_t count, const std::function<void(size_t, size_t)>& body);
+
+private:
+    void worker_loop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+// Pool sized from RECIPE_THREADS (unset or 0 = all cores, 1 = serial)
+ThreadPool& shared_thread_pool();
+
+// Switch used to compare serial and parallel timings at runtime
+bool parallel_enabled();
+void set_parallel_enabled(bool enabled);
+
+// Runs body over [0, count) on the shared pool, or inline when parallelism is off
+void parallel_for(size_t count, const std::function<void(size_t, size_t)>& body);
@@ -0,0 +1,426 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "vectorIndex.hpp"
+#include "data.hpp"
+#include "symSpell.hpp"
+#include "threadPool.hpp"
+
+// Same field weights as the BM25 ranking: name words count most, then ingredients, then directions
+static constexpr float kNameWeight = 3.0f;
+static constexpr float kIngredientWeight = 2.0f;
+static constexpr float kDirectionsWeight = 1.0f;
+
+static constexpr uint32_t kFileMagic = 0x58495652; // "RVIX"
+static constexpr uint32_t kFileVersion = 2;
+static constexpr uint32_t kMaxLayers = 32;
+
+// FNV-1a, then the splitmix64 finalizer so every bit range is usable on its own
+static uint64_t word_hash(const std::string& word) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : word) h = (h ^ c) * 0x100000001b3ULL;
+    h += 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+// Low bits pick the vector bucket, the top bit its sign, the middle bits the document frequency slot
+static size_t bucket_of(uint64_t h) { return h % VectorIndex::kDimensions; }
+static float sign_of(uint64_t h) { return (h >> 63) ? -1.0f : 1.0f; }
+static size_t slot_of(uint64_t h, size_t slots) { return (h >> 32) & (slots - 1); }
+
+static std::string ingredient_text(const Recipe& r) {
+    std::string text;
+    for (const Ingredient& ing : r.ingredients) text += ing.name + "\n";
+    return text;
+}
+
+uint64_t VectorIndex::recipes_fingerprint() {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    auto feed = [&](const std::string& s) {
+        for (unsigned char c : s) h = (h ^ c) * 0x100000001b3ULL;
+        h = (h ^ 0x1e) * 0x100000001b3ULL; // separator, so moved boundaries change the hash
+    };
+    feed(std::to_string(recipes.size()) + "/" + std::to_string(kDimensions) + "/" + std::to_string(kMaxLinks));
+    for (const Recipe& r : recipes) {
+        feed(r.name);
+        for (const Ingredient& ing : r.ingredients) feed(ing.name);
+        feed(r.directions);
+    }
+    return h;
+}
+
+void VectorIndex::clear() {
+    std::fill(document_frequency.begin(), document_frequency.end(), 0);
+    document_count = 0;
+    vector_offsets.assign(1, 0);
+    vector_buckets.clear();
+    vector_weights.clear();
+    links.clear();
+    entry_point = 0;
+    top_layer = -1;
+    level_state = 0x9E3779B97F4A7C15ull;
+}
+
+void VectorIndex::count_words(uint32_t recipe_id) {
+    const Recipe& r = recipes[recipe_id];
+    std::unordered_set<size_t> slots;
+    for (const std::string* text : {&r.name, &r.directions}) {
+        for (const std::string& word : split_vocabulary_words(*text))
+            slots.insert(slot_of(word_hash(word), kFrequencySlots));
+    }
+    for (const std::string& word : split_vocabulary_words(ingredient_text(r)))
+        slots.insert(slot_of(word_hash(word), kFrequencySlots));
+    for (size_t slot : slots) ++document_frequency[slot];
+    ++document_count;
+}
+
+// Words the recipes never use carry no weight: they could only match through hash collisions
+VectorIndex::Vector VectorIndex::vectorize(const std::vector<std::pair<std::string, float>>& weighted_text) const {
+    std::unordered_map<uint64_t, float> term_weights;
+    for (const auto& [text, weight] : weighted_text) {
+        for (const std::string& word : split_vocabulary_words(text)) term_weights[word_hash(word)] += weight;
+    }
+
+    Vector v{};
+    for (const auto& [h, tf] : term_weights) {
+        uint32_t df = document_frequency[slot_of(h, kFrequencySlots)];
+        if (df == 0) continue;
+        float idf = std::log((document_count + 1.0f) / (df + 1.0f)) + 1.0f;
+        v[bucket_of(h)] += sign_of(h) * (1.0f + std::log(tf)) * idf;
+    }
+
+    float norm = 0.0f;
+    for (float x : v) norm += x * x;
+    if (norm > 0.0f) {
+        norm = 1.0f / std::sqrt(norm);
+        for (float& x : v) x *= norm;
+    }
+    return v;
+}
+
+VectorIndex::SparseVector VectorIndex::recipe_vector(uint32_t recipe_id) const {
+    const Recipe& r = recipes[recipe_id];
+    Vector dense = vectorize({{r.name, kNameWeight}, {ingredient_text(r), kIngredientWeight}, {r.directions, kDirectionsWeight}});
+    SparseVector sparse;
+    for (size_t bucket = 0; bucket < kDimensions; ++bucket) {
+        if (dense[bucket] != 0.0f) sparse.emplace_back(static_cast<uint16_t>(bucket), dense[bucket]);
+    }
+    return sparse;
+}
+
+void VectorIndex::append_vector(const SparseVector& v) {
+    for (const auto& [bucket, weight] : v) {
+        vector_buckets.push_back(bucket);
+        vector_weights.push_back(weight);
+    }
+    vector_offsets.push_back(static_cast<uint32_t>(vector_buckets.size()));
+}
+
+VectorIndex::Vector VectorIndex::dense_vector(uint32_t recipe_id) const {
+    Vector v{};
+    for (uint32_t k = vector_offsets[recipe_id]; k < vector_offsets[recipe_id + 1]; ++k)
+        v[vector_buckets[k]] = vector_weights[k];
+    return v;
+}
+
+// Exponentially distributed levels with the 1/ln(M) normalisation of the HNSW paper
+int VectorIndex::random_level() {
+    level_state += 0x9e3779b97f4a7c15ULL;
+    uint64_t x = level_state;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    double u = ((x >> 11) + 1.0) / 9007199254740993.0; // (0, 1]
+    int level = static_cast<int>(-std::log(u) / std::log(static_cast<double>(kMaxLinks)));
+    return std::min<int>(level, kMaxLayers - 1);
+}
+
+// One minus the dot product: a gather of the dense query at the recipe's buckets
+float VectorIndex::distance(const Vector& a, uint32_t b) const {
+    float dot = 0.0f;
+    for (uint32_t k = vector_offsets[b]; k < vector_offsets[b + 1]; ++k) dot += a[vector_buckets[k]] * vector_weights[k];
+    return 1.0f - dot;
+}
+
+// Beam search of one layer from entry; the beam closest nodes found, nearest first
+std::vector<VectorIndex::Candidate> VectorIndex::search_layer(const Vector& query, uint32_t entry, size_t beam,
+                                                              int layer, const std::atomic<bool>* cancelled) const {
+    std::vector<char> visited(size(), 0);
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> frontier; // nearest on top
+    std::priority_queue<Candidate> found;                                                     // farthest on top
+
+    Candidate start{distance(query, entry), entry};
+    visited[entry] = 1;
+    frontier.push(start);
+    found.push(start);
+    for (size_t expanded = 0; !frontier.empty(); ++expanded) {
+        Candidate current = frontier.top();
+        if (current.first > found.top().first && found.size() >= beam) break;
+        if (cancelled && expanded % 64 == 0 && cancelled->load(std::memory_order_relaxed)) break;
+        frontier.pop();
+        for (uint32_t neighbour : links[current.second][layer]) {
+            if (visited[neighbour]) continue;
+            visited[neighbour] = 1;
+            float d = distance(query, neighbour);
+            if (found.size() < beam || d < found.top().first) {
+                frontier.push({d, neighbour});
+                found.push({d, neighbour});
+                if (found.size() > beam) found.pop();
+            }
+        }
+    }
+
+    std::vector<Candidate> result(found.size());
+    for (size_t i = result.size(); i-- > 0; found.pop()) result[i] = found.top();
+    return result;
+}
+
+// Neighbour selection heuristic over candidates measured from one node: a candidate is linked only
+// when it is closer to that node than to every neighbour already chosen, which keeps links pointing
+// in different directions. Skipped candidates fill any remaining room.
+std::vector<uint32_t> VectorIndex::select_links(std::vector<Candidate> candidates, size_t max_links) const {
+    std::sort(candidates.begin(), candidates.end());
+    std::vector<uint32_t> chosen, skipped;
+    Vector from{};
+    for (const auto& [d, id] : candidates) {
+        if (chosen.size() >= max_links) break;
+        // Expanded once, so each comparison is a gather rather than a merge of two sparse vectors
+        if (!chosen.empty()) from = dense_vector(id);
+        bool diverse = std::all_of(chosen.begin(), chosen.end(),
+                                   [&](uint32_t other) { return distance(from, other) >= d; });
+        (diverse ? chosen : skipped).push_back(id);
+    }
+    for (size_t i = 0; i < skipped.size() && chosen.size() < max_links; ++i) chosen.push_back(skipped[i]);
+    return chosen;
+}
+
+void VectorIndex::insert(uint32_t recipe_id) {
+    const Vector v = dense_vector(recipe_id);
+    int level = random_level();
+    links[recipe_id].assign(level + 1, {});
+    if (top_layer < 0) {
+        entry_point = recipe_id;
+        top_layer = level;
+        return;
+    }
+
+    // Greedy descent through the layers above the new node's, then linking on each of its layers
+    uint32_t entry = entry_point;
+    for (int layer = top_layer; layer > level; --layer) entry = search_layer(v, entry, 1, layer).front().second;
+    for (int layer = std::min(level, top_layer); layer >= 0; --layer) {
+        std::vector<Candidate> nearby = search_layer(v, entry, kBuildBeam, layer);
+        size_t max_links = layer == 0 ? kMaxBaseLinks : kMaxLinks;
+        links[recipe_id][layer] = select_links(nearby, kMaxLinks);
+        for (uint32_t neighbour : links[recipe_id][layer]) {
+            std::vector<uint32_t>& back = links[neighbour][layer];
+            back.push_back(recipe_id);
+            if (back.size() <= max_links) continue;
+            std::vector<Candidate> current;
+            const Vector from = dense_vector(neighbour);
+            for (uint32_t other : back) current.push_back({distance(from, other), other});
+            back = select_links(std::move(current), max_links);
+        }
+        entry = nearby.front().second;
+    }
+    if (level > top_layer) {
+        entry_point = recipe_id;
+        top_layer = level;
+    }
+}
+
+void VectorIndex::build() {
+    clear();
+    for (uint32_t r = 0; r < recipes.size(); ++r) count_words(r);
+    std::vector<SparseVector> sparse(recipes.size());
+    parallel_for(recipes.size(), [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) sparse[r] = recipe_vector(static_cast<uint32_t>(r));
+    });
+    for (const SparseVector& v : sparse) append_vector(v);
+    links.resize(recipes.size());
+    for (uint32_t r = 0; r < recipes.size(); ++r) insert(r);
+}
+
+void VectorIndex::add_recipe(uint32_t recipe_id) {
+    if (recipe_id != size()) return;
+    count_words(recipe_id);
+    append_vector(recipe_vector(recipe_id));
+    links.emplace_back();
+    insert(recipe_id);
+}
+
+// Cosine similarities of the closest candidates, ending at the first that shares no word
+static std::vector<VectorMatch> to_matches(const std::vector<std::pair<float, uint32_t>>& ranked) {
+    std::vector<VectorMatch> matches;
+    for (const auto& [d, id] : ranked) {
+        if (1.0f - d <= 0.0f) break;
+        matches.push_back({id, 1.0f - d});
+    }
+    return matches;
+}
+
+static bool is_zero(const std::array<float, VectorIndex::kDimensions>& v) {
+    return std::all_of(v.begin(), v.end(), [](float x) { return x == 0.0f; });
+}
+
+std::vector<VectorMatch> VectorIndex::nearest(const std::string& text, size_t k, const std::vector<char>& allowed,
+                                              const std::atomic<bool>* cancelled) const {
+    const bool filtered = !allowed.empty();
+    size_t allowed_count = filtered ? std::count(allowed.begin(), allowed.end(), 1) : size();
+    if (allowed_count <= 4 * kSearchBeam) return nearest_exact(text, k, allowed);
+
+    Vector query = vectorize({{text, 1.0f}});
+    if (k == 0 || is_zero(query)) return {};
+
+    // Widen the beam by the share of recipes the filter removes, so k allowed ones survive
+    size_t beam = std::max(kSearchBeam, k);
+    if (filtered) beam = std::min(size(), beam * size() / allowed_count);
+    uint32_t entry = entry_point;
+    for (int layer = top_layer; layer > 0; --layer) entry = search_layer(query, entry, 1, layer).front().second;
+
+    std::vector<Candidate> ranked;
+    for (const Candidate& c : search_layer(query, entry, beam, 0, cancelled)) {
+        if (ranked.size() >= k) break;
+        if (!filtered || (c.second < allowed.size() && allowed[c.second])) ranked.push_back(c);
+    }
+    return to_matches(ranked);
+}
+
+std::vector<VectorMatch> VectorIndex::nearest_exact(const std::string& text, size_t k,
+                                                    const std::vector<char>& allowed) const {
+    Vector query = vectorize({{text, 1.0f}});
+    if (size() == 0 || k == 0 || is_zero(query)) return {};
+
+    std::vector<Candidate> ranked;
+    for (uint32_t id = 0; id < size(); ++id) {
+        if (allowed.empty() || (id < allowed.size() && allowed[id])) ranked.push_back({distance(query, id), id});
+    }
+    size_t keep = std::min(k, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + keep, ranked.end());
+    ranked.resize(keep);
+    return to_matches(ranked);
+}
+
+size_t VectorIndex::memory_bytes() const {
+    size_t bytes = document_frequency.size() * sizeof(uint32_t) + vector_offsets.size() * sizeof(uint32_t) +
+                   vector_buckets.size() * sizeof(uint16_t) + vector_weights.size() * sizeof(float);
+    for (const auto& layers : links) {
+        for (const auto& layer : layers) bytes += layer.size() * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+// File layout, native byte order: magic, version, dimensions, fingerprint, document count,
+// recipe count, entry point, top layer, the document frequency slots, the sparse vectors (entry
+// count, recipe count + 1 offsets, the buckets, the weights), then per recipe its layer count and
+// per layer the neighbour count and ids
+bool VectorIndex::save(const std::string& path) const {
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        auto put = [&](const auto& value) { out.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+        put(kFileMagic);
+        put(kFileVersion);
+        put(static_cast<uint32_t>(kDimensions));
+        put(recipes_fingerprint());
+        put(document_count);
+        put(static_cast<uint32_t>(size()));
+        put(entry_point);
+        put(static_cast<int32_t>(top_layer));
+        out.write(reinterpret_cast<const char*>(document_frequency.data()), document_frequency.size() * sizeof(uint32_t));
+        put(static_cast<uint32_t>(vector_buckets.size()));
+        out.write(reinterpret_cast<const char*>(vector_offsets.data()), vector_offsets.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(vector_buckets.data()), vector_buckets.size() * sizeof(uint16_t));
+        out.write(reinterpret_cast<const char*>(vector_weights.data()), vector_weights.size() * sizeof(float));
+        for (const auto& layers : links) {
+            put(static_cast<uint32_t>(layers.size()));
+            for (const auto& layer : layers) {
+                put(static_cast<uint32_t>(layer.size()));
+                out.write(reinterpret_cast<const char*>(layer.data()), layer.size() * sizeof(uint32_t));
+            }
+        }
+        if (!out) return false;
+    }
+    // Written aside and renamed, so an interrupted save never leaves a truncated index behind
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    return !ec;
+}
+
+bool VectorIndex::load(const std::string& path) {
+    clear();
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    auto get = [&](auto& value) { return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value))); };
+
+    uint32_t magic = 0, version = 0, dimensions = 0, count = 0, entry = 0;
+    uint64_t fingerprint = 0;
+    int32_t layer_top = -1;
+    bool ok = get(magic) && magic == kFileMagic && get(version) && version == kFileVersion &&
+              get(dimensions) && dimensions == kDimensions && get(fingerprint) &&
+              fingerprint == recipes_fingerprint() && get(document_count) && get(count) &&
+              count == recipes.size() && get(entry) && get(layer_top) &&
+              layer_top < static_cast<int32_t>(kMaxLayers) && (count == 0 || entry < count);
+    ok = ok && in.read(reinterpret_cast<char*>(document_frequency.data()), document_frequency.size() * sizeof(uint32_t));
+    uint32_t entries = 0;
+    ok = ok && get(entries) && entries <= static_cast<uint64_t>(count) * kDimensions;
+    if (ok) {
+        vector_offsets.resize(static_cast<size_t>(count) + 1);
+        vector_buckets.resize(entries);
+        vector_weights.resize(entries);
+        ok = in.read(reinterpret_cast<char*>(vector_offsets.data()), vector_offsets.size() * sizeof(uint32_t)) &&
+             in.read(reinterpret_cast<char*>(vector_buckets.data()), vector_buckets.size() * sizeof(uint16_t)) &&
+             in.read(reinterpret_cast<char*>(vector_weights.data()), vector_weights.size() * sizeof(float));
+    }
+    // Offsets must run from 0 to the entry count, and each recipe's buckets ascend within range
+    ok = ok && vector_offsets.front() == 0 && vector_offsets.back() == entries;
+    for (uint32_t r = 0; ok && r < count; ++r) {
+        ok = vector_offsets[r] <= vector_offsets[r + 1];
+        for (uint32_t k = vector_offsets[r]; ok && k < vector_offsets[r + 1]; ++k)
+            ok = vector_buckets[k] < kDimensions && (k == vector_offsets[r] || vector_buckets[k - 1] < vector_buckets[k]);
+    }
+    links.resize(ok ? count : 0);
+    for (uint32_t r = 0; ok && r < count; ++r) {
+        uint32_t layer_count = 0;
+        ok = get(layer_count) && layer_count >= 1 && layer_count <= kMaxLayers;
+        if (ok) links[r].resize(layer_count);
+        for (uint32_t layer = 0; ok && layer < layer_count; ++layer) {
+            uint32_t n = 0;
+            ok = get(n) && n <= kMaxBaseLinks;
+            if (!ok) break;
+            links[r][layer].resize(n);
+            ok = static_cast<bool>(in.read(reinterpret_cast<char*>(links[r][layer].data()), n * sizeof(uint32_t)));
+            // Every neighbour must exist on this layer
+            for (uint32_t id : links[r][layer]) ok = ok && id < count;
+        }
+    }
+    for (uint32_t r = 0; ok && r < count; ++r) {
+        for (size_t layer = 0; ok && layer < links[r].size(); ++layer)
+            for (uint32_t id : links[r][layer]) ok = ok && layer < links[id].size();
+    }
+    ok = ok && (count == 0 ? layer_top == -1 : layer_top + 1 == static_cast<int32_t>(links[entry].size()));
+
+    if (!ok) {
+        clear();
+        return false;
+    }
+    entry_point = entry;
+    top_layer = layer_top;
+    for (uint32_t r = 0; r < count; ++r) random_level(); // continue the level sequence for appended recipes
+    return true;
+}
+
+bool VectorIndex::load_or_build(const std::string& path) {
+    if (load(path)) return true;
+    build();
+    if (!save(path)) std::cerr << "Could not write the vector index to " << path << "\n";
+    return false;
+}
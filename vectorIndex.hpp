@@ -0,0 +1,91 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct VectorMatch {
+    uint32_t recipe_id;
+    float similarity; // cosine similarity to the query, 1 for identical word profiles
+};
+
+// Approximate nearest-neighbour search over hashed TF-IDF vectors, built entirely offline.
+// Every word of a recipe's name, ingredients and directions is hashed to a signed bucket of a
+// kDimensions-wide vector and weighted by field, log term frequency and inverse document
+// frequency; the vector is then L2-normalised so a dot product is the cosine similarity.
+// A recipe touches only a small share of the buckets, so recipe vectors are kept (and saved)
+// sparse as sorted (bucket, weight) pairs; only a query is expanded to a dense vector.
+// An HNSW graph (layered small-world graph, searched greedily from the top layer down) finds
+// the closest recipes without comparing against all of them. The graph can be written to disk
+// with a fingerprint of the recipe text, so launches with unchanged recipes only read it back.
+class VectorIndex {
+public:
+    static constexpr size_t kDimensions = 1024;
+    static constexpr size_t kMaxLinks = 16;       // per node and layer above 0 (M)
+    static constexpr size_t kMaxBaseLinks = 32;   // on layer 0
+    static constexpr size_t kBuildBeam = 100;     // candidate list while linking (efConstruction)
+    static constexpr size_t kSearchBeam = 64;     // smallest candidate list of a query (efSearch)
+
+    void build();
+    // Recipes must be added in id order. Document frequencies are updated, but vectors already in
+    // the graph keep the weights they were built with until the next build.
+    void add_recipe(uint32_t recipe_id);
+    void clear();
+
+    // Reads the graph from path when it was saved for the current recipes; otherwise builds it
+    // and writes it there. True when it was read back.
+    bool load_or_build(const std::string& path);
+    bool save(const std::string& path) const;
+    // False, leaving the index empty, when the file is missing, corrupt or for other recipes
+    bool load(const std::string& path);
+
+    // The k recipes closest to the text, best first. allowed (by recipe id) restricts them when
+    // not empty; small allowed sets are compared exactly instead of through the graph. When
+    // *cancelled becomes true the graph walk stops and the answer is incomplete.
+    std::vector<VectorMatch> nearest(const std::string& text, size_t k, const std::vector<char>& allowed,
+                                     const std::atomic<bool>* cancelled = nullptr) const;
+    // The same answer by comparing against every allowed recipe
+    std::vector<VectorMatch> nearest_exact(const std::string& text, size_t k, const std::vector<char>& allowed) const;
+
+    size_t size() const { return vector_offsets.size() - 1; }
+    size_t memory_bytes() const;
+
+    // Hash of the indexed text of every recipe, stored alongside the saved graph
+    static uint64_t recipes_fingerprint();
+
+private:
+    using Vector = std::array<float, kDimensions>;
+    using SparseVector = std::vector<std::pair<uint16_t, float>>; // (bucket, weight), by bucket
+    using Candidate = std::pair<float, uint32_t>; // (distance, recipe id)
+    static_assert(kDimensions <= 65536, "buckets are stored as uint16_t");
+
+    static constexpr size_t kFrequencySlots = 1 << 16;
+
+    Vector vectorize(const std::vector<std::pair<std::string, float>>& weighted_text) const;
+    SparseVector recipe_vector(uint32_t recipe_id) const;
+    void append_vector(const SparseVector& v);
+    Vector dense_vector(uint32_t recipe_id) const;
+    void count_words(uint32_t recipe_id);
+    void insert(uint32_t recipe_id);
+    int random_level();
+
+    float distance(const Vector& a, uint32_t b) const;
+    std::vector<Candidate> search_layer(const Vector& query, uint32_t entry, size_t beam, int layer,
+                                        const std::atomic<bool>* cancelled = nullptr) const;
+    std::vector<uint32_t> select_links(std::vector<Candidate> candidates, size_t max_links) const;
+
+    std::vector<uint32_t> document_frequency = std::vector<uint32_t>(kFrequencySlots, 0); // by word hash slot
+    uint32_t document_count = 0;
+
+    // Sparse vectors by recipe id: recipe r owns entries [vector_offsets[r], vector_offsets[r + 1])
+    std::vector<uint32_t> vector_offsets = std::vector<uint32_t>(1, 0);
+    std::vector<uint16_t> vector_buckets;
+    std::vector<float> vector_weights;
+    std::vector<std::vector<std::vector<uint32_t>>> links; // [recipe id][layer] -> neighbours
+    uint32_t entry_point = 0;
+    int top_layer = -1;
+    uint64_t level_state = 0x9E3779B97F4A7C15ull;         // deterministic level draws
+};